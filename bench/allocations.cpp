@@ -0,0 +1,30 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+#include "allocations.h"
+
+#include <cstdlib>
+#include <new>
+
+// Replaces the global operator new/delete to count every allocation, including those during
+// static initialization. Kept in its own translation unit, so the compiler can't pair inlined
+// deletes with the builtin operator new.
+
+namespace {
+size_t allocations{};
+}
+
+auto allocationCount() -> size_t {
+    return allocations;
+}
+
+void* operator new(size_t size) {
+    ++allocations;
+    if (auto p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc{};
+}
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+void operator delete(void* p, size_t) noexcept {
+    std::free(p);
+}
@@ -0,0 +1,9 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+#pragma once
+
+#include <cstddef>
+
+// number of calls to the global operator new so far, see allocations.cpp
+// (object library clice-allocations, linked into test_clice and the startup benchmark)
+auto allocationCount() -> size_t;
@@ -0,0 +1,87 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Compares the compile time of translation units using clice via '#include <clice/clice.h>'
+# against 'import clice;' (src/clice/clice.cppm).
+# Generates N translation units declaring a few arguments each and compiles them sequentially.
+#
+# usage: compile_time.sh <clice source dir> <c++ compiler> [compiler flags, e.g. -I<fmt include dir>]...
+# environment:
+#   N - number of translation units (default 50)
+set -euo pipefail
+
+if [ $# -lt 2 ]; then
+    echo "usage: $0 <clice source dir> <c++ compiler> [flags]..."
+    exit 1
+fi
+
+SRC="$(realpath "$1")/src"
+CXX="$2"
+shift 2
+FLAGS=(-std=c++20 -O0 -I"${SRC}" "$@")
+N=${N:-50}
+
+DIR="$(mktemp -d)"
+trap 'rm -rf "${DIR}"' EXIT
+cd "${DIR}"
+
+# writes tu_<i>.cpp, $1 is the line making clice available
+generate() {
+    local prelude="$1" i
+    for (( i=0; i < N; ++i )); do
+        cat > "tu_${i}.cpp" <<EOF
+${prelude}
+
+namespace tu_${i} {
+auto cliCommand = clice::Argument{ .args = "command${i}", .desc = "a command" };
+auto cliFlag    = clice::Argument{ .parent = &cliCommand, .args = "--flag", .desc = "a flag" };
+auto cliInt     = clice::Argument{ .parent = &cliCommand, .args = "--int", .desc = "an int", .value = int{${i}} };
+auto cliString  = clice::Argument{ .parent = &cliCommand, .args = "--string", .desc = "a string", .value = std::string{} };
+auto cliList    = clice::Argument{ .parent = &cliCommand, .args = "--list", .desc = "a list", .value = std::vector<double>{} };
+}
+EOF
+    done
+}
+
+now() {
+    date +%s%N
+}
+
+# compiles all tu_*.cpp, prints the time in seconds
+compile_all() {
+    local start end i
+    start=$(now)
+    for (( i=0; i < N; ++i )); do
+        "${CXX}" "${FLAGS[@]}" "$@" -c "tu_${i}.cpp" -o "tu_${i}.o"
+    done
+    end=$(now)
+    awk -v t=$(( end - start )) 'BEGIN { printf "%.2f", t / 1e9 }'
+}
+
+printf "%-8s %12s %12s %12s\n" "variant" "module[s]" "TUs[s]" "per TU[ms]"
+
+generate "#include <clice/clice.h>"
+header=$(compile_all)
+printf "%-8s %12s %12s %12.1f\n" "header" "-" "${header}" "$(awk -v t="${header}" -v n="${N}" 'BEGIN { print t * 1000 / n }')"
+
+rm -f tu_*
+generate "#include <string>
+#include <vector>
+import clice;"
+if "${CXX}" --version | grep -q clang; then
+    BUILD_MODULE=(--precompile -x c++-module "${SRC}/clice/clice.cppm" -o clice.pcm)
+    USE_MODULE=(-fmodule-file=clice=clice.pcm)
+else
+    BUILD_MODULE=(-fmodules-ts -x c++ -c "${SRC}/clice/clice.cppm" -o clice.o)
+    USE_MODULE=(-fmodules-ts)
+fi
+start=$(now)
+if ! "${CXX}" "${FLAGS[@]}" "${BUILD_MODULE[@]}"; then
+    echo "building the clice module failed, modules require e.g. gcc >= 14 or clang >= 16" >&2
+    exit 1
+fi
+end=$(now)
+module=$(awk -v t=$(( end - start )) 'BEGIN { printf "%.2f", t / 1e9 }')
+tus=$(compile_all "${USE_MODULE[@]}")
+printf "%-8s %12s %12s %12.1f\n" "module" "${module}" "${tus}" "$(awk -v t="${tus}" -v n="${N}" 'BEGIN { print t * 1000 / n }')"
@@ -0,0 +1,101 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Measures the time from pressing TAB to having suggestions, by calling the completion
+# functions generated by clice with a synthetic COMP_LINE (bash) or words/CURRENT (zsh).
+#
+# usage: completion_latency.sh <executable>...
+# environment:
+#   ITERATIONS - number of measurements per case (default 200)
+set -euo pipefail
+
+ITERATIONS=${ITERATIONS:-200}
+
+if [ $# -eq 0 ]; then
+    echo "usage: $0 <executable>..."
+    exit 1
+fi
+
+# words that are being completed: all options and an option prefix
+CASES=("" "--")
+
+# prints "<p50> <p99>" in ms of the microsecond values given on stdin
+percentiles() {
+    sort -n | awk '{ v[NR] = $1 } END {
+        p50 = v[int((NR - 1) * 0.50) + 1]
+        p99 = v[int((NR - 1) * 0.99) + 1]
+        printf "%8.3f %8.3f", p50 / 1000, p99 / 1000
+    }'
+}
+
+bench_bash() {
+    local exe="$1" mode="$2" word="$3"
+    bash -c '
+        exe="$1"; mode="$2"; word="$3"; n="$4"
+        compopt() { :; }
+        if [ "${mode}" = "dynamic" ]; then
+            source <(CLICE_GENERATE_COMPLETION=$$ "${exe}")
+            fn=clice_GetOpts
+        else
+            source <(CLICE_GENERATE_STATIC_COMPLETION=bash "${exe}")
+            fn=$(complete -p | sed -n "s/^complete -F \([^ ]*\) .*/\1/p" | tail -n 1)
+        fi
+        COMP_WORDS=("${exe}" "${word}")
+        COMP_CWORD=1
+        COMP_LINE="${exe} ${word}"
+        COMP_POINT=${#COMP_LINE}
+        for (( i=0; i < n; ++i )); do
+            start=${EPOCHREALTIME/[.,]/}
+            "${fn}"
+            end=${EPOCHREALTIME/[.,]/}
+            echo $(( end - start ))
+        done
+    ' bench "${exe}" "${mode}" "${word}" "${ITERATIONS}" | percentiles
+}
+
+bench_zsh() {
+    local exe="$1" mode="$2" word="$3"
+    zsh -c '
+        zmodload zsh/datetime
+        exe="$1"; mode="$2"; word="$3"; n="$4"
+        compdef() { :; }
+        compadd() { :; }
+        _files() { :; }
+        if [ "${mode}" = "dynamic" ]; then
+            source <(CLICE_GENERATE_COMPLETION=$$ "${exe}")
+            fn=clice_GetOpts
+        else
+            source <(CLICE_GENERATE_STATIC_COMPLETION=zsh "${exe}")
+            fn=_clice_${${exe:t}//[^a-zA-Z0-9]/_}
+        fi
+        words=("${exe}" "${word}")
+        CURRENT=2
+        for (( i=0; i < n; ++i )); do
+            start=${EPOCHREALTIME/./}
+            "${fn}"
+            end=${EPOCHREALTIME/./}
+            echo $(( end - start ))
+        done
+    ' bench "${exe}" "${mode}" "${word}" "${ITERATIONS}" | percentiles
+}
+
+SHELLS=(bash)
+if command -v zsh > /dev/null; then
+    SHELLS+=(zsh)
+else
+    echo "zsh not found, skipping zsh measurements" >&2
+fi
+
+printf "%-24s %-5s %-8s %-6s %8s %8s\n" "executable" "shell" "mode" "word" "p50[ms]" "p99[ms]"
+for exe in "$@"; do
+    exe="$(realpath "${exe}")"
+    for shell in "${SHELLS[@]}"; do
+        for mode in dynamic static; do
+            for word in "${CASES[@]}"; do
+                result=$(bench_${shell} "${exe}" "${mode}" "${word}")
+                printf "%-24s %-5s %-8s %-6s %s\n" "$(basename "${exe}")" "${shell}" "${mode}" "'${word}'" "${result}"
+            done
+        done
+    done
+done
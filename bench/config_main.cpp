@@ -0,0 +1,50 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+#include <clice/clice.h>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <vector>
+
+/**
+ * main of the clice-bench-config-* executables, the arguments are generated by generate_arguments.sh,
+ * the config file by generate_config.sh
+ *
+ * Loads the config file several times and prints one line:
+ *   <keys> <first load[us]> <median load[us]> <median per key[ns]>
+ *
+ * usage: clice-bench-config-<n> <config file> [repetitions (default 21)]
+ */
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        fmt::print(stderr, "usage: {} <config file> [repetitions]\n", argv[0]);
+        return 1;
+    }
+    auto repetitions = (argc > 2)?std::max(1, std::atoi(argv[2])):21;
+
+    using Clock = std::chrono::steady_clock;
+    auto keys  = size_t{};
+    auto times = std::vector<double>{};
+    try {
+        for (int i{0}; i < repetitions; ++i) {
+            auto start = Clock::now();
+            keys = clice::loadConfig(argv[1]);
+            times.push_back(std::chrono::duration<double, std::micro>(Clock::now() - start).count());
+        }
+        // the config doesn't replace parsing of argv
+        char const* args[] = {argv[0]};
+        if (auto failed = clice::parse(std::size(args), args); failed) {
+            fmt::print(stderr, "parsing failed: {}\n", *failed);
+            return 1;
+        }
+    } catch (std::exception const& e) {
+        fmt::print(stderr, "error: {}\n", e.what());
+        return 1;
+    }
+    auto first = times.front();
+    std::ranges::sort(times);
+    auto median = times[times.size() / 2];
+    fmt::print("{} {:.0f} {:.0f} {:.1f}\n", keys, first, median, keys?median * 1000. / keys:0.);
+}
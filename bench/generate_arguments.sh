@@ -0,0 +1,64 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Generates translation units declaring global clice::Arguments for benchmarks.
+# The arguments mix commands, flags, typed values, suffixes, mappings, lists and callbacks,
+# every TU starts with a command, the following arguments are its children.
+#
+# usage: generate_arguments.sh <number of arguments> <number of TUs> <output dir>
+# writes <output dir>/args_<i>.cpp for i in [0, <number of TUs>)
+set -euo pipefail
+
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <number of arguments> <number of TUs> <output dir>"
+    exit 1
+fi
+
+COUNT=$1
+TUS=$2
+OUT=$3
+mkdir -p "${OUT}"
+
+for (( tu=0; tu < TUS; ++tu )); do
+    begin=$(( tu * COUNT / TUS ))
+    end=$(( (tu + 1) * COUNT / TUS ))
+    file="${OUT}/args_${tu}.cpp"
+    {
+        echo "// generated by generate_arguments.sh, do not edit"
+        echo "#include <clice/clice.h>"
+        echo ""
+        echo "namespace {"
+        echo "[[maybe_unused]] int calls{};"
+        echo "enum class Mode { Fast, Slow };"
+        for (( i=begin; i < end; ++i )); do
+            local_idx=$(( i - begin ))
+            parent=""
+            if [ $(( local_idx % 16 )) -ne 0 ]; then
+                parent=".parent = &arg_$(( begin + local_idx / 16 * 16 )), "
+            fi
+            case $(( local_idx % 16 )) in
+                0)       echo "auto arg_${i} = clice::Argument{ .args = \"cmd${i}\", .desc = \"command ${i}\" };" ;;
+                1|9)     echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--flag${i}\", .desc = \"flag ${i}\" };" ;;
+                2|10)    echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--int${i}\", .desc = \"int ${i}\", .value = int{${i}} };" ;;
+                3)       echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--size${i}\", .desc = \"size ${i}\", .value = size_t{${i}}, .suffix = \"b\" };" ;;
+                4|12)    echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--string${i}\", .desc = \"string ${i}\", .value = std::string{} };" ;;
+                5)       echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--path${i}\", .desc = \"path ${i}\", .value = std::filesystem::path{} };" ;;
+                6)       echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--mode${i}\", .desc = \"mode ${i}\", .value = Mode::Fast, .mapping = {{{\"fast\", Mode::Fast}, {\"slow\", Mode::Slow}}} };" ;;
+                7)       echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--ints${i}\", .desc = \"ints ${i}\", .value = std::vector<int>{} };" ;;
+                8)       echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--cb${i}\", .desc = \"callback ${i}\", .cb = []() { ++calls; } };" ;;
+                11)      echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--double${i}\", .desc = \"double ${i}\", .value = double{0.5}, .cb = [](double) { ++calls; } };" ;;
+                13)      echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--level${i}\", .desc = \"level ${i}\", .value = int{1}, .mapping = {{{\"low\", 1}, {\"high\", 2}}} };" ;;
+                14)      echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--bool${i}\", .env = \"BENCH_BOOL${i}\", .desc = \"bool ${i}\", .value = false };" ;;
+                15)      echo "auto arg_${i} = clice::Argument{ ${parent}.args = \"--strings${i}\", .desc = \"strings ${i}\", .value = std::vector<std::string>{} };" ;;
+            esac
+        done
+        echo "}"
+    } > "${file}.tmp"
+    # keep the timestamp if nothing changed, avoids recompiling
+    if cmp -s "${file}.tmp" "${file}"; then
+        rm "${file}.tmp"
+    else
+        mv "${file}.tmp" "${file}"
+    fi
+done
@@ -0,0 +1,44 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Generates a config file that sets every argument of generate_arguments.sh (same parameters),
+# one section per command.
+#
+# usage: generate_config.sh <number of arguments> <number of TUs> <output file>
+set -euo pipefail
+
+if [ $# -ne 3 ]; then
+    echo "usage: $0 <number of arguments> <number of TUs> <output file>"
+    exit 1
+fi
+
+COUNT=$1
+TUS=$2
+OUT=$3
+
+{
+    echo "# generated by generate_config.sh, do not edit"
+    for (( tu=0; tu < TUS; ++tu )); do
+        begin=$(( tu * COUNT / TUS ))
+        end=$(( (tu + 1) * COUNT / TUS ))
+        for (( i=begin; i < end; ++i )); do
+            case $(( (i - begin) % 16 )) in
+                0)       echo ""; echo "[cmd${i}]" ;;
+                1|9)     echo "flag${i} = true" ;;
+                2|10)    echo "int${i} = $(( i * 3 ))" ;;
+                3)       echo "size${i} = 4kb" ;;
+                4|12)    echo "string${i} = \"value ${i}\"" ;;
+                5)       echo "path${i} = /tmp/file${i}" ;;
+                6)       echo "mode${i} = slow" ;;
+                7)       echo "ints${i} = ${i}" ;;
+                8)       echo "cb${i} = false" ;;
+                11)      echo "double${i} = 1.5k" ;;
+                13)      echo "level${i} = high" ;;
+                14)      echo "bool${i} = true" ;;
+                15)      echo "strings${i} = abc" ;;
+            esac
+        done
+    done
+} > "${OUT}.tmp"
+mv "${OUT}.tmp" "${OUT}"
@@ -0,0 +1,18 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+#include <clice/clice.h>
+
+#include <iostream>
+
+// main of the clice-size-* executables, the arguments are generated by generate_arguments.sh
+int main(int argc, char** argv) {
+    try {
+        if (auto failed = clice::parse(argc, argv); failed) {
+            std::cerr << "parsing failed: " << *failed << "\n";
+            return 1;
+        }
+    } catch (std::exception const& e) {
+        std::cerr << "error: " << e.what() << "\n";
+        return 1;
+    }
+}
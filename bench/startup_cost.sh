@@ -0,0 +1,32 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Reports the startup cost of programs with many global clice::Arguments: time from exec to main
+# (static registration), time in clice::parse, peak RSS and number of allocations.
+# Times are the median of several runs.
+#
+# usage: startup_cost.sh <clice-bench-startup executable>...
+# environment:
+#   ITERATIONS - number of runs per executable (default 21)
+set -euo pipefail
+
+ITERATIONS=${ITERATIONS:-21}
+
+if [ $# -eq 0 ]; then
+    echo "usage: $0 <executable>..."
+    exit 1
+fi
+
+printf "%10s %14s %12s %10s %12s %12s\n" "arguments" "exec->main[us]" "parse[us]" "rss[kB]" "allocs init" "allocs parse"
+for exe in "$@"; do
+    for (( i=0; i < ITERATIONS; ++i )); do
+        "${exe}"
+    done | awk -v n="${ITERATIONS}" '
+        { args = $1; exec[NR] = $2; parse[NR] = $3; rss[NR] = $4; init = $5; alloc = $6 }
+        function median(v,    i, j, t) {
+            for (i = 1; i <= n; ++i) for (j = i + 1; j <= n; ++j) if (v[j] < v[i]) { t = v[i]; v[i] = v[j]; v[j] = t }
+            return v[int((n + 1) / 2)]
+        }
+        END { printf "%10s %14s %12s %10s %12s %12s\n", args, median(exec), median(parse), median(rss), init, alloc }'
+done
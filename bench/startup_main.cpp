@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+#include "allocations.h"
+
+#include <clice/clice.h>
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <fmt/format.h>
+#include <string>
+#include <sys/resource.h>
+#include <unistd.h>
+
+/**
+ * main of the clice-bench-startup-* executables, the arguments are generated by generate_arguments.sh
+ *
+ * The program re-executes itself with the time of the exec call in CLICE_BENCH_EXEC_NS, the second
+ * process measures the time until main is reached (loading and static registration of all arguments)
+ * and the time spent in clice::parse. It prints one line:
+ *   <arguments> <exec to main[us]> <parse[us]> <peak rss[kB]> <allocations before main> <allocations in parse>
+ */
+
+namespace {
+auto now() -> int64_t {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+}
+
+int main(int, char** argv) {
+    auto mainReached     = now();
+    auto allocationsInit = allocationCount();
+
+    auto execNs = std::getenv("CLICE_BENCH_EXEC_NS");
+    if (!execNs) {
+        auto env = std::to_string(now());
+        setenv("CLICE_BENCH_EXEC_NS", env.c_str(), 1);
+        execv("/proc/self/exe", argv);
+        execv(argv[0], argv);
+        fmt::print(stderr, "re-executing {} failed\n", argv[0]);
+        return 1;
+    }
+
+    // touches a command, flags, values, a mapping and callbacks of the first generated block
+    char const* args[] = {argv[0], "cmd0", "--flag1", "--int2", "7", "--string4", "abc", "--mode6", "slow", "--cb8", "--double11", "1.5"};
+    auto parseStart = now();
+    try {
+        if (auto failed = clice::parse(std::size(args), args); failed) {
+            fmt::print(stderr, "parsing failed: {}\n", *failed);
+            return 1;
+        }
+    } catch (std::exception const& e) {
+        fmt::print(stderr, "error: {}\n", e.what());
+        return 1;
+    }
+    auto parseEnd         = now();
+    auto allocationsParse = allocationCount() - allocationsInit;
+
+    auto usage = rusage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    auto peakRss = usage.ru_maxrss / 1024;
+#else
+    auto peakRss = usage.ru_maxrss;
+#endif
+
+    fmt::print("{} {} {} {} {} {}\n", CLICE_BENCH_ARGUMENTS,
+                                     (mainReached - std::stoll(execNs)) / 1000,
+                                     (parseEnd - parseStart) / 1000,
+                                     peakRss,
+                                     allocationsInit,
+                                     allocationsParse);
+}
@@ -0,0 +1,26 @@
+#!/usr/bin/env bash
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+#
+# Reports the size of the .text section per 100 options, from two executables
+# that only differ in the number of generated options.
+#
+# usage: text_size.sh <options of first> <first executable> <options of second> <second executable>
+set -euo pipefail
+
+if [ $# -ne 4 ]; then
+    echo "usage: $0 <options> <executable> <options> <executable>"
+    exit 1
+fi
+
+text() {
+    size -A "$1" | awk '$1 == ".text" { print $2 }'
+}
+
+n1=$1; t1=$(text "$2")
+n2=$3; t2=$(text "$4")
+
+printf "%-24s %8s %12s\n" "executable" "options" ".text[bytes]"
+printf "%-24s %8s %12s\n" "$(basename "$2")" "${n1}" "${t1}"
+printf "%-24s %8s %12s\n" "$(basename "$4")" "${n2}" "${t2}"
+echo ".text per 100 options: $(( (t2 - t1) * 100 / (n2 - n1) )) bytes"
@@ -0,0 +1,16 @@
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+
+# Runs a clice based executable with a generator environment variable set
+# and writes its standard output into a file.
+#
+# usage: cmake -DEXECUTABLE=<exe> -DVARIABLE=<env var> -DVALUE=<value> -DOUTPUT=<file> -P CliceRunGenerator.cmake
+set(ENV{${VARIABLE}} "${VALUE}")
+execute_process(COMMAND "${EXECUTABLE}"
+                OUTPUT_FILE "${OUTPUT}.tmp"
+                RESULT_VARIABLE result)
+if (NOT result EQUAL 0)
+    file(REMOVE "${OUTPUT}.tmp")
+    message(FATAL_ERROR "running ${EXECUTABLE} with ${VARIABLE}=${VALUE} failed: ${result}")
+endif ()
+file(RENAME "${OUTPUT}.tmp" "${OUTPUT}")
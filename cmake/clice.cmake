@@ -0,0 +1,103 @@
+# SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+# SPDX-License-Identifier: CC0-1.0
+
+set(CLICE_CMAKE_DIR "${CMAKE_CURRENT_LIST_DIR}")
+
+# clice_add_completion(<target> [ALL] [SHELLS <shell>...] [DESTINATION <dir>])
+#
+# Adds the target <target>-completion, which generates static completion scripts
+# (<target>.bash, <target>.zsh, <target>.fish) for the clice based executable <target>.
+# Default shells are bash, zsh and fish, default destination is the current binary dir.
+function(clice_add_completion target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "ALL" "DESTINATION" "SHELLS")
+    if (NOT ARG_SHELLS)
+        set(ARG_SHELLS bash zsh fish)
+    endif ()
+    if (NOT ARG_DESTINATION)
+        set(ARG_DESTINATION "${CMAKE_CURRENT_BINARY_DIR}")
+    endif ()
+
+    set(outputs)
+    foreach (shell IN LISTS ARG_SHELLS)
+        set(output "${ARG_DESTINATION}/${target}.${shell}")
+        add_custom_command(OUTPUT "${output}"
+                           COMMAND ${CMAKE_COMMAND}
+                                   -DEXECUTABLE=$<TARGET_FILE:${target}>
+                                   -DVARIABLE=CLICE_GENERATE_STATIC_COMPLETION
+                                   -DVALUE=${shell}
+                                   -DOUTPUT=${output}
+                                   -P "${CLICE_CMAKE_DIR}/CliceRunGenerator.cmake"
+                           DEPENDS ${target}
+                           COMMENT "Generating ${shell} completion for ${target}")
+        list(APPEND outputs "${output}")
+    endforeach ()
+    if (ARG_ALL)
+        add_custom_target(${target}-completion ALL DEPENDS ${outputs})
+    else ()
+        add_custom_target(${target}-completion DEPENDS ${outputs})
+    endif ()
+endfunction()
+
+# clice_embed_help(<target>)
+#
+# Renders the help pages of the clice based executable <target> at build time and compiles
+# them into <target>, '--help' then prints the static text (see src/clice/embeddedHelp.h).
+# For this <target> is built a second time as <target>-helpgen, which is run with
+# CLICE_GENERATE_EMBEDDED_HELP set. The test <target>-embedded-help checks that the
+# embedded pages match the runtime renderer.
+function(clice_embed_help target)
+    get_target_property(sources ${target} SOURCES)
+    get_target_property(source_dir ${target} SOURCE_DIR)
+    list(TRANSFORM sources PREPEND "${source_dir}/" REGEX "^[^/$]")
+
+    add_executable(${target}-helpgen ${sources})
+    foreach (property LINK_LIBRARIES INCLUDE_DIRECTORIES COMPILE_DEFINITIONS COMPILE_OPTIONS)
+        get_target_property(value ${target} ${property})
+        if (value)
+            set_property(TARGET ${target}-helpgen PROPERTY ${property} ${value})
+        endif ()
+    endforeach ()
+
+    set(output "${CMAKE_CURRENT_BINARY_DIR}/${target}-help.cpp")
+    add_custom_command(OUTPUT "${output}"
+                       COMMAND ${CMAKE_COMMAND}
+                               -DEXECUTABLE=$<TARGET_FILE:${target}-helpgen>
+                               -DVARIABLE=CLICE_GENERATE_EMBEDDED_HELP
+                               -DVALUE=1
+                               -DOUTPUT=${output}
+                               -P "${CLICE_CMAKE_DIR}/CliceRunGenerator.cmake"
+                       DEPENDS ${target}-helpgen
+                       COMMENT "Generating embedded help pages for ${target}")
+    target_sources(${target} PRIVATE "${output}")
+
+    add_test(NAME ${target}-embedded-help
+             COMMAND ${CMAKE_COMMAND} -E env CLICE_CHECK_EMBEDDED_HELP=1 $<TARGET_FILE:${target}>)
+endfunction()
+
+# clice_add_schema(<target> [ALL] [DESTINATION <dir>])
+#
+# Adds the target <target>-schema, which writes the JSON schema of all arguments and
+# subcommands of the clice based executable <target> into <target>.schema.json
+# (see src/clice/generateSchema.h). Default destination is the current binary dir.
+function(clice_add_schema target)
+    cmake_parse_arguments(PARSE_ARGV 1 ARG "ALL" "DESTINATION" "")
+    if (NOT ARG_DESTINATION)
+        set(ARG_DESTINATION "${CMAKE_CURRENT_BINARY_DIR}")
+    endif ()
+
+    set(output "${ARG_DESTINATION}/${target}.schema.json")
+    add_custom_command(OUTPUT "${output}"
+                       COMMAND ${CMAKE_COMMAND}
+                               -DEXECUTABLE=$<TARGET_FILE:${target}>
+                               -DVARIABLE=CLICE_GENERATE_SCHEMA
+                               -DVALUE=1
+                               -DOUTPUT=${output}
+                               -P "${CLICE_CMAKE_DIR}/CliceRunGenerator.cmake"
+                       DEPENDS ${target}
+                       COMMENT "Generating schema for ${target}")
+    if (ARG_ALL)
+        add_custom_target(${target}-schema ALL DEPENDS "${output}")
+    else ()
+        add_custom_target(${target}-schema DEPENDS "${output}")
+    endif ()
+endfunction()
@@ -0,0 +1,69 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+
+// Synthetic tool with 1'000 options, used to benchmark completion and parsing:
+//  - 10 subcommands with 40 options each
+//  - 250 flags, 250 integer options and 90 options with a mapping of 20 values
+#include <clice/clice.h>
+
+#include <fmt/format.h>
+#include <list>
+#include <memory>
+
+int main(int argc, char** argv) {
+    auto names = std::list<std::string>{};
+    auto name  = [&](std::string str) -> char const* {
+        names.emplace_back(std::move(str));
+        return names.back().c_str();
+    };
+    auto modes = std::unordered_map<std::string, int>{};
+    for (int i{0}; i < 20; ++i) {
+        modes.try_emplace(fmt::format("mode{:02}", i), i);
+    }
+
+    // parents are declared first, so they are destroyed last
+    auto commands = std::vector<std::unique_ptr<clice::Argument<>>>{};
+    auto flags    = std::vector<std::unique_ptr<clice::Argument<>>>{};
+    auto ints     = std::vector<std::unique_ptr<clice::Argument<int>>>{};
+    auto mapped   = std::vector<std::unique_ptr<clice::Argument<int>>>{};
+    auto children = std::vector<std::unique_ptr<clice::Argument<int, std::function<void()>, std::nullptr_t>>>{};
+
+    for (int i{0}; i < 10; ++i) {
+        commands.emplace_back(new clice::Argument<>{
+            .args = name(fmt::format("cmd{}", i)),
+            .desc = "synthetic subcommand",
+        });
+        for (int j{0}; j < 40; ++j) {
+            children.emplace_back(new clice::Argument<int, std::function<void()>, std::nullptr_t>{
+                .parent = commands.back().get(),
+                .args   = name(fmt::format("--cmd{}-opt{:02}", i, j)),
+                .desc   = "synthetic subcommand option",
+            });
+        }
+    }
+    for (int i{0}; i < 250; ++i) {
+        flags.emplace_back(new clice::Argument<>{
+            .args = name(fmt::format("--flag{:03}", i)),
+            .desc = "synthetic flag",
+        });
+        ints.emplace_back(new clice::Argument<int>{
+            .args  = name(fmt::format("--int{:03}", i)),
+            .desc  = "synthetic integer option",
+            .value = i,
+        });
+    }
+    for (int i{0}; i < 90; ++i) {
+        mapped.emplace_back(new clice::Argument<int>{
+            .args    = name(fmt::format("--mode{:02}", i)),
+            .desc    = "synthetic option with mapping",
+            .mapping = modes,
+        });
+    }
+
+    clice::parse({
+        .args            = {argc, argv},
+        .desc            = "synthetic tool with 1'000 options",
+        .catchExceptions = true,
+    });
+    return 0;
+}
@@ -0,0 +1,313 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: CC0-1.0
+
+// Microbenchmarks of the hot functions of clice: parse, parseSingleDash, parseFromString<T>,
+// generateHelp, makeCompletionSuggestion and generateCWL.
+//
+// Results are written as JSON, the format is stable so results of different commits can be compared:
+//   {"clice-bench":1,"compiler":"...","min_time_ms":...,"repetitions":...,
+//    "benchmarks":[{"name":"...","iterations":...,"ns_per_op":{"min":...,"median":...,"max":...}}...]}
+// "iterations" is the number of calls per repetition, "ns_per_op" is taken over the repetitions.
+#include <clice/clice.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fcntl.h>
+#include <fmt/format.h>
+#include <unistd.h>
+
+namespace {
+auto cliFilter      = clice::Argument{ .args   = "--filter",
+                                       .id     = "<substring>",
+                                       .desc   = "only run benchmarks whose name contains <substring>",
+                                       .value  = std::string{},
+};
+auto cliMinTime     = clice::Argument{ .args   = "--min-time",
+                                       .id     = "<ms>",
+                                       .desc   = "minimal time of each repetition",
+                                       .value  = size_t{50},
+};
+auto cliRepetitions = clice::Argument{ .args   = "--repetitions",
+                                       .desc   = "number of measurements of each benchmark",
+                                       .value  = size_t{9},
+};
+auto cliOutput      = clice::Argument{ .args   = {"-o", "--output"},
+                                       .id     = "<file>",
+                                       .desc   = "writes the results to <file> instead of stdout",
+                                       .value  = std::filesystem::path{},
+};
+
+// arguments of a typical tool, these are the ones being parsed
+namespace fixture {
+enum class Mode { Fast, Balanced, Slow };
+
+auto cliVerbose = clice::Argument{ .args = {"-v", "--verbose"}, .desc = "more output" };
+auto cliQuiet   = clice::Argument{ .args = {"-q", "--quiet"}, .desc = "less output" };
+auto cliThreads = clice::Argument{ .args = {"-j", "--threads"}, .desc = "number of threads", .value = size_t{1} };
+auto cliName    = clice::Argument{ .args = "--name", .desc = "name of the run", .value = std::string{} };
+auto cliInput   = clice::Argument{ .args = {"-i", "--input"}, .desc = "input file", .value = std::filesystem::path{} };
+auto cliMemory  = clice::Argument{ .args = "--memory", .desc = "memory limit", .value = size_t{}, .suffix = "b" };
+auto cliRatio   = clice::Argument{ .args = "--ratio", .desc = "some ratio", .value = 0.5 };
+auto cliValues  = clice::Argument{ .args = "--values", .desc = "list of values", .value = std::vector<int>{} };
+auto cliMode    = clice::Argument{ .args    = "--mode",
+                                   .desc    = "speed of the run",
+                                   .value   = Mode::Balanced,
+                                   .mapping = {{{"fast", Mode::Fast}, {"balanced", Mode::Balanced}, {"slow", Mode::Slow}}},
+};
+auto cliBuild   = clice::Argument{ .args = "build", .desc = "builds a target" };
+auto cliTarget  = clice::Argument{ .parent = &cliBuild, .args = "--target", .desc = "target to build", .value = std::string{"all"} };
+auto cliJobs    = clice::Argument{ .parent = &cliBuild, .args = "--jobs", .desc = "parallel jobs", .value = int{1} };
+auto cliRelease = clice::Argument{ .parent = &cliBuild, .args = "--release", .desc = "release build" };
+}
+
+struct Result {
+    std::string         name;
+    size_t              iterations;
+    std::vector<double> nsPerOp; // sorted
+};
+
+auto results = std::vector<Result>{};
+
+// keeps the compiler from optimizing the benchmarked calls away
+volatile size_t sink{};
+
+/**
+ * Measures f, which returns some size_t depending on its result.
+ * The number of iterations is doubled until a repetition takes at least --min-time.
+ */
+template <typename F>
+void bench(std::string name, F&& f) {
+    if (!cliFilter->empty() and name.find(*cliFilter) == std::string::npos) return;
+
+    using Clock = std::chrono::steady_clock;
+    auto measure = [&](size_t iterations) -> double {
+        auto start = Clock::now();
+        auto acc   = size_t{};
+        for (size_t i{0}; i < iterations; ++i) {
+            acc += f();
+        }
+        sink = sink + acc;
+        return std::chrono::duration<double, std::nano>(Clock::now() - start).count();
+    };
+
+    auto minTime    = double(*cliMinTime) * 1'000'000.;
+    auto iterations = size_t{1};
+    while (measure(iterations) < minTime) {
+        iterations *= 2;
+    }
+
+    auto result = Result{std::move(name), iterations, {}};
+    for (size_t i{0}; i < std::max<size_t>(*cliRepetitions, 1); ++i) {
+        result.nsPerOp.push_back(measure(iterations) / iterations);
+    }
+    std::ranges::sort(result.nsPerOp);
+    fmt::print(stderr, "{:<48} {:>12.1f} ns\n", result.name, result.nsPerOp[result.nsPerOp.size() / 2]);
+    results.push_back(std::move(result));
+}
+
+auto parseArgs(std::vector<std::string_view> args, bool allowDashCombi = false) -> size_t {
+    auto failed = clice::parse(args, allowDashCombi);
+    fixture::cliValues.value.clear();
+    return failed.has_value();
+}
+
+void benchParse() {
+    bench("parse/empty", [args = std::vector<std::string_view>{"tool"}]() {
+        return parseArgs(args);
+    });
+    bench("parse/typical", [args = std::vector<std::string_view>{"tool", "-v", "--threads", "8", "--name", "run1", "--input", "data.txt",
+                                                                 "--mode", "fast", "--ratio", "0.25"}]() {
+        return parseArgs(args);
+    });
+    bench("parse/subcommand", [args = std::vector<std::string_view>{"tool", "--quiet", "build", "--target", "clice", "--jobs", "4", "--release"}]() {
+        return parseArgs(args);
+    });
+    bench("parse/suffix", [args = std::vector<std::string_view>{"tool", "--memory", "16Mib", "--ratio", "90deg"}]() {
+        return parseArgs(args);
+    });
+
+    // pathological: very long argv
+    auto values = std::vector<std::string>{};
+    for (int i{0}; i < 1000; ++i) {
+        values.push_back(std::to_string(i));
+    }
+    auto longList = std::vector<std::string_view>{"tool", "--values"};
+    longList.insert(longList.end(), values.begin(), values.end());
+    bench("parse/list-1000-values", [&]() {
+        return parseArgs(longList);
+    });
+    auto repeatedFlags = std::vector<std::string_view>{"tool"};
+    repeatedFlags.insert(repeatedFlags.end(), 1000, "--verbose");
+    bench("parse/flag-1000-times", [&]() {
+        return parseArgs(repeatedFlags);
+    });
+    bench("parse/unknown-argument", [args = std::vector<std::string_view>{"tool", "-v", "--unknown"}]() {
+        try {
+            return parseArgs(args);
+        } catch (std::exception const&) {
+            return size_t{1};
+        }
+    });
+
+    bench("parseSingleDash/combined", [args = std::vector<std::string_view>{"tool", "-vq", "-j", "8"}]() {
+        return parseArgs(args, true);
+    });
+    auto longCombi = std::string{"-"} + std::string(500, 'v');
+    bench("parseSingleDash/combined-500", [args = std::vector<std::string_view>{"tool", longCombi}]() {
+        return parseArgs(args, true);
+    });
+
+    // the state of parse/typical, restored instead of parsed
+    parseArgs({"tool", "-v", "--threads", "8", "--name", "run1", "--input", "data.txt", "--mode", "fast", "--ratio", "0.25"});
+    auto blob = clice::saveSnapshot();
+    bench("snapshot/save-typical", []() {
+        return clice::saveSnapshot().size();
+    });
+    bench("snapshot/restore-typical", [&]() {
+        clice::restoreSnapshot(blob);
+        return blob.size();
+    });
+}
+
+template <typename T>
+void benchFromString(std::string_view type, std::string_view label, std::string_view input) {
+    bench(fmt::format("parseFromString/{}/{}", type, label), [input]() {
+        auto value = clice::parseFromString<T>(input);
+        if constexpr (std::is_arithmetic_v<T>) {
+            return size_t(value);
+        } else {
+            return sizeof(value);
+        }
+    });
+}
+
+void benchConversion() {
+    benchFromString<bool>("bool", "plain", "true");
+    benchFromString<char>("char", "plain", "x");
+    benchFromString<int8_t>("int8", "plain", "-12");
+    benchFromString<uint8_t>("uint8", "plain", "200");
+    benchFromString<int16_t>("int16", "plain", "-1234");
+    benchFromString<uint16_t>("uint16", "plain", "60000");
+    benchFromString<int32_t>("int32", "plain", "-123456");
+    benchFromString<int32_t>("int32", "separator", "1'000'000");
+    benchFromString<int32_t>("int32", "binary", "0b101010");
+    benchFromString<uint32_t>("uint32", "plain", "4000000000");
+    benchFromString<int64_t>("int64", "plain", "-123456789012");
+    benchFromString<uint64_t>("uint64", "plain", "12345678901234");
+    benchFromString<uint64_t>("uint64", "suffix-k", "64k");
+    benchFromString<uint64_t>("uint64", "suffix-Mi", "16Mi");
+    benchFromString<uint64_t>("uint64", "suffix-Ei", "1Ei");
+    benchFromString<float>("float", "plain", "3.25");
+    benchFromString<double>("double", "plain", "-1234.5678");
+    benchFromString<double>("double", "suffix-k", "1.5k");
+    benchFromString<double>("double", "suffix-m", "250m");
+    benchFromString<double>("double", "suffix-deg", "90deg");
+    benchFromString<double>("double", "suffix-pi", "0.5pi");
+    benchFromString<std::string>("string", "plain", "some string value");
+    benchFromString<std::filesystem::path>("path", "plain", "/usr/share/doc/clice/README.md");
+}
+
+void benchHelp() {
+    bench("generateHelp/all", []() {
+        return clice::generateHelp().size();
+    });
+    bench("generateHelp/subcommand", []() {
+        return clice::generateHelp(fixture::cliBuild.storage.arg).size();
+    });
+}
+
+void benchCompletion() {
+    // suggestions are printed to stdout
+    std::fflush(stdout);
+    auto savedStdout = dup(STDOUT_FILENO);
+    auto devNull     = open("/dev/null", O_WRONLY);
+    dup2(devNull, STDOUT_FILENO);
+
+    auto noBases = std::vector<clice::ArgumentBase*>{};
+    bench("makeCompletionSuggestion/options", [&]() {
+        clice::makeCompletionSuggestion(noBases, false, "--");
+        return size_t{1};
+    });
+    auto modeBase = std::vector<clice::ArgumentBase*>{&fixture::cliMode.storage.arg};
+    bench("makeCompletionSuggestion/mapping", [&]() {
+        clice::makeCompletionSuggestion(modeBase, true, "f");
+        return size_t{1};
+    });
+    auto buildBase = std::vector<clice::ArgumentBase*>{&fixture::cliBuild.storage.arg};
+    bench("makeCompletionSuggestion/subcommand", [&]() {
+        clice::makeCompletionSuggestion(buildBase, false, "--");
+        return size_t{1};
+    });
+
+    std::fflush(stdout);
+    dup2(savedStdout, STDOUT_FILENO);
+    close(devNull);
+    close(savedStdout);
+}
+
+void benchCWL() {
+#ifdef CLICE_USE_TDL
+    bench("generateCWL/all", []() {
+        return clice::generateCWL({}).params.size();
+    });
+    bench("generateCWL/subcommand", []() {
+        return clice::generateCWL({"build"}).params.size();
+    });
+#endif
+}
+
+auto compiler() -> std::string {
+#if defined(__clang__)
+    return fmt::format("clang {}.{}.{}", __clang_major__, __clang_minor__, __clang_patchlevel__);
+#elif defined(__GNUC__)
+    return fmt::format("gcc {}.{}.{}", __GNUC__, __GNUC_MINOR__, __GNUC_PATCHLEVEL__);
+#elif defined(_MSC_VER)
+    return fmt::format("msvc {}", _MSC_VER);
+#else
+    return "unknown";
+#endif
+}
+
+void writeResults() {
+    auto out = fmt::memory_buffer{};
+    out.append(std::string_view{"{\"clice-bench\":1,\"compiler\":"});
+    clice::writeJsonString(out, compiler());
+    fmt::format_to(std::back_inserter(out), ",\"min_time_ms\":{},\"repetitions\":{},\"benchmarks\":[", *cliMinTime, *cliRepetitions);
+    for (size_t i{0}; i < results.size(); ++i) {
+        auto const& r = results[i];
+        if (i > 0) out.push_back(',');
+        out.append(std::string_view{"\n{\"name\":"});
+        clice::writeJsonString(out, r.name);
+        fmt::format_to(std::back_inserter(out), ",\"iterations\":{},\"ns_per_op\":{{\"min\":{:.2f},\"median\":{:.2f},\"max\":{:.2f}}}}}",
+                       r.iterations, r.nsPerOp.front(), r.nsPerOp[r.nsPerOp.size() / 2], r.nsPerOp.back());
+    }
+    out.append(std::string_view{"\n]}\n"});
+
+    auto file = stdout;
+    if (!cliOutput->empty()) {
+        file = std::fopen(cliOutput->c_str(), "w");
+        if (!file) {
+            throw std::runtime_error{fmt::format("can't open {}", cliOutput->string())};
+        }
+    }
+    std::fwrite(out.data(), 1, out.size(), file);
+    if (file != stdout) std::fclose(file);
+}
+}
+
+int main(int argc, char** argv) {
+    clice::parse({
+        .args            = {argc, argv},
+        .desc            = "microbenchmarks of clice, results are written as JSON",
+        .helpOpt         = true,
+        .catchExceptions = true,
+        .run = []() {
+            benchParse();
+            benchConversion();
+            benchHelp();
+            benchCompletion();
+            benchCWL();
+            writeResults();
+        }
+    });
+}
@@ -2,19 +2,27 @@
 // SPDX-License-Identifier: ISC
 #pragma once
 
+#include "config.h"
+#include "lazyValue.h"
 #include "parseString.h"
+#include "reloadable.h"
+#include "typeDescriptor.h"
 
 #include <algorithm>
-#include <any>
+#include <chrono>
 #include <cstddef>
+#include <cstdint>
+#include <cstring>
 #include <filesystem>
 #include <functional>
 #include <limits>
 #include <optional>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <typeindex>
 #include <typeinfo>
+#include <unordered_map>
 #include <unordered_set>
 #include <utility>
 #include <vector>
@@ -23,6 +31,51 @@ namespace clice {
 
 inline std::string argv0; // Parser will fill this
 
+// opt-in caching of '.completion' results, see completionCache.h
+struct CompletionCache {
+    std::chrono::seconds      ttl{60};     // cached results younger than this are used without calling '.completion'
+    std::chrono::milliseconds budget{100}; // time to wait for '.completion', afterwards stale results are used
+};
+
+struct ArgumentBase;
+
+/**
+ * Arguments in registration order, linked through ArgumentBase::prev and ArgumentBase::next
+ *
+ * Each argument is in exactly one list (the children of its parent or Register::arguments), so
+ * it unregisters itself in O(1) and tearing down n arguments is O(n) in any order.
+ */
+struct ArgumentList {
+    struct iterator {
+        using value_type      = ArgumentBase*;
+        using difference_type = std::ptrdiff_t;
+
+        ArgumentBase* arg{};
+
+        auto operator*() const -> ArgumentBase* { return arg; }
+        auto operator++() -> iterator&;
+        auto operator++(int) -> iterator { auto r = *this; ++*this; return r; }
+        auto operator==(iterator const&) const -> bool = default;
+    };
+
+    ArgumentList() = default;
+    ArgumentList(ArgumentList const&) = delete;
+    auto operator=(ArgumentList const&) -> ArgumentList& = delete;
+
+    void push_back(ArgumentBase* arg);
+    void erase(ArgumentBase* arg);
+
+    auto begin() const -> iterator { return {first}; }
+    auto end() const -> iterator { return {}; }
+    auto size() const -> size_t { return count; }
+    auto empty() const -> bool { return count == 0; }
+
+private:
+    ArgumentBase* first{};
+    ArgumentBase* last{};
+    size_t        count{};
+};
+
 struct ArgumentBase {
     ArgumentBase*                           parent{};
     std::vector<std::string>                args;
@@ -31,20 +84,31 @@ struct ArgumentBase {
     std::string                             desc;
     std::optional<std::vector<std::string>> mapping{};
     std::unordered_set<std::string>         tags;
-    std::optional<std::string>              completion{};
     std::function<std::vector<std::string>()> completion_fn;
-    std::vector<ArgumentBase*>              children;  // child parameters
+    std::optional<CompletionCache>          completion_cache{};
+    ArgumentList                            children;  // child parameters
+    ArgumentBase*                           prev{};    // siblings in registration order (see ArgumentList)
+    ArgumentBase*                           next{};
+    mutable std::function<void()>           lazyChildren; // registers the children on first use (see expandChildren)
     bool                                    symlink{};  // a symlink for example to "slix-env" should actually call "slix env"
+    bool                                    isSet{};    // was given on the command line or via environment variable
+    bool                                    fromConfig{}; // value was set by a config file, environment and argv replace it (see configFile.h)
     std::type_index                         type_index;
+    TypeDescriptor const*                   type;
 
     std::function<void()> init;
     std::function<void(std::string_view)>       fromString;
     std::function<std::optional<std::string>()> toString;
+    std::function<void(std::string&)>            saveValue; // binary copy of the value for snapshots (see snapshot.h)
+    std::function<void(std::string_view&)>       loadValue;
+    std::function<void()>                        prefetchValue; // evaluates an invocable value (see prefetch.h)
+    std::function<void()>                        clearValue;    // empties a list value
+    std::function<void(std::string_view)>        storeValue;    // publishes a value of a Reloadable, without init() (see reload.h)
     std::function<void()> cb;
     size_t                cb_priority;
 
     ArgumentBase() = delete;
-    ArgumentBase(ArgumentBase* parent, std::type_index idx);
+    ArgumentBase(ArgumentBase* parent, std::type_index idx, TypeDescriptor const& type);
     virtual ~ArgumentBase();
     ArgumentBase(ArgumentBase const&) = delete;
     ArgumentBase(ArgumentBase&&) = delete;
@@ -52,10 +116,34 @@ struct ArgumentBase {
     auto operator=(ArgumentBase&&) -> ArgumentBase& = delete;
 
     void validateOrThrowInvariant() const;
+    auto expandChildren() const -> bool;
 };
 
+inline auto ArgumentList::iterator::operator++() -> iterator& {
+    arg = arg->next;
+    return *this;
+}
+
+inline void ArgumentList::push_back(ArgumentBase* arg) {
+    arg->prev = last;
+    arg->next = nullptr;
+    (last?last->next:first) = arg;
+    last = arg;
+    ++count;
+}
+
+inline void ArgumentList::erase(ArgumentBase* arg) {
+    (arg->prev?arg->prev->next:first) = arg->next;
+    (arg->next?arg->next->prev:last)  = arg->prev;
+    arg->prev = arg->next = nullptr;
+    --count;
+}
+
 struct Register {
-    std::vector<ArgumentBase*> arguments;
+    ArgumentList               arguments;
+    std::vector<ArgumentBase*> prefetch; // arguments with .prefetch (see prefetch.h)
+    // root commands with .symlink by name, a program called "tool-<name>" is parsed as "tool <name>"
+    std::unordered_map<std::string_view, ArgumentBase*> symlinks;
 
     static auto getInstance() -> Register& {
         static Register instance;
@@ -63,9 +151,14 @@ struct Register {
     }
 };
 
-inline ArgumentBase::ArgumentBase(ArgumentBase* parent, std::type_index idx)
+CLICE_INLINE void registerSymlink(ArgumentBase& arg);
+CLICE_INLINE auto findSymlink(std::string_view argv0) -> ArgumentBase*;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE ArgumentBase::ArgumentBase(ArgumentBase* parent, std::type_index idx, TypeDescriptor const& type)
     : parent{parent}
     , type_index{idx}
+    , type{&type}
 {
     if (parent) {
         parent->children.push_back(this);
@@ -75,17 +168,72 @@ inline ArgumentBase::ArgumentBase(ArgumentBase* parent, std::type_index idx)
     }
 }
 
-inline ArgumentBase::~ArgumentBase() {
+CLICE_INLINE ArgumentBase::~ArgumentBase() {
+    if (prefetchValue) {
+        std::erase(Register::getInstance().prefetch, this);
+    }
+    if (symlink and !parent and !args.empty()) {
+        auto& symlinks = Register::getInstance().symlinks;
+        if (auto iter = symlinks.find(args[0]); iter != symlinks.end() and iter->second == this) {
+            symlinks.erase(iter);
+        }
+    }
     if (parent) {
-        auto& children = parent->children;
-        children.erase(std::remove(children.begin(), children.end(), this), children.end());
+        parent->children.erase(this);
     } else {
-        auto& children = Register::getInstance().arguments;
-        children.erase(std::remove(children.begin(), children.end(), this), children.end());
+        Register::getInstance().arguments.erase(this);
     }
 }
 
-inline void ArgumentBase::validateOrThrowInvariant() const {
+/**
+ * Registers the children of a command with .lazyChildren, if that didn't happen yet
+ * Called when the command is selected (clice::parse, completion, config files, reload) and by
+ * everything walking the argument tree (help, schema, snapshots...).
+ * returns true if the children were registered by this call
+ */
+CLICE_INLINE auto ArgumentBase::expandChildren() const -> bool {
+    if (!lazyChildren) return false;
+    auto registerChildren = std::move(lazyChildren);
+    lazyChildren = nullptr;
+    registerChildren();
+    return true;
+}
+
+// throws if the name is ambiguous: with "add" and "file", "tool-add-file" could mean "tool add-file" or "tool-add file"
+CLICE_INLINE void registerSymlink(ArgumentBase& arg) {
+    if (arg.parent or arg.args.empty()) return;
+    auto name = std::string_view{arg.args[0]};
+    auto isSuffix = [](std::string_view str, std::string_view suffix) {
+        return str.size() > suffix.size() and str.ends_with(suffix) and str[str.size() - suffix.size() - 1] == '-';
+    };
+    auto& symlinks = Register::getInstance().symlinks;
+    for (auto const& [other, _] : symlinks) {
+        if (other == name or isSuffix(name, other) or isSuffix(other, name)) {
+            throw std::runtime_error{"symlinked commands \"" + std::string{name} + "\" and \"" + std::string{other} + "\" are ambiguous"};
+        }
+    }
+    symlinks.emplace(name, &arg);
+}
+
+// the symlinked command, if the file name of argv0 is "<anything>-<name>"
+CLICE_INLINE auto findSymlink(std::string_view argv0) -> ArgumentBase* {
+    auto const& symlinks = Register::getInstance().symlinks;
+    if (symlinks.empty()) return nullptr;
+#ifdef _WIN32
+    auto filename = argv0.substr(argv0.find_last_of("/\\") + 1);
+#else
+    auto filename = argv0.substr(argv0.find_last_of('/') + 1);
+#endif
+    // registerSymlink guarantees that at most one suffix matches
+    for (auto pos = filename.find('-'); pos != std::string_view::npos; pos = filename.find('-', pos+1)) {
+        if (auto iter = symlinks.find(filename.substr(pos+1)); iter != symlinks.end()) {
+            return iter->second;
+        }
+    }
+    return nullptr;
+}
+
+CLICE_INLINE void ArgumentBase::validateOrThrowInvariant() const {
     auto const& self = *this;
     auto checkAgainstOther = [&](ArgumentBase const* child) {
         if (&self == child) return;
@@ -107,6 +255,7 @@ inline void ArgumentBase::validateOrThrowInvariant() const {
         }
     }
 }
+#endif
 
 struct ListOfStrings : std::vector<std::string> {
     ListOfStrings() {}
@@ -120,12 +269,392 @@ struct ListOfStrings : std::vector<std::string> {
     }
 };
 
-template <typename S>
-constexpr bool HasPushBack = requires {
-    typename S::value_type;
-    { std::declval<S>().push_back(std::declval<typename S::value_type>()) };
+/**
+ * Value conversion
+ *
+ * Everything that only depends on the value type T lives outside of Argument<T, CBType, TParents...>,
+ * so it is instantiated once per value type and not once per combination of callback and parent types.
+ */
+template <typename T>
+using Mapping = std::optional<std::unordered_map<std::string, T>>;
+
+CLICE_INLINE auto stripSuffix(std::string_view s, std::optional<std::string> const& suffix) -> std::string_view;
+[[noreturn]] CLICE_INLINE void throwInvalidValue(std::string_view s, std::vector<std::string> const& validValues);
+[[noreturn]] CLICE_INLINE void throwTruncatedSnapshot();
+CLICE_INLINE auto noValueString() -> std::optional<std::string>;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE auto stripSuffix(std::string_view s, std::optional<std::string> const& suffix) -> std::string_view {
+    if (!suffix) return s;
+    if (!s.ends_with(*suffix)) {
+        throw std::runtime_error{"expected the suffix \"" + *suffix + "\""};
+    }
+    return s.substr(0, s.size() - suffix->size());
+}
+
+[[noreturn]] CLICE_INLINE void throwInvalidValue(std::string_view s, std::vector<std::string> const& validValues) {
+    auto list = std::string{};
+    for (auto const& v : validValues) {
+        if (!list.empty()) list += ", ";
+        list += v;
+    }
+    throw std::runtime_error{"invalid value \"" + std::string{s} + "\". Valid values are: [ " + list + " ]"};
+}
+
+[[noreturn]] CLICE_INLINE void throwTruncatedSnapshot() {
+    throw std::runtime_error{"snapshot is truncated"};
+}
+
+CLICE_INLINE auto noValueString() -> std::optional<std::string> {
+    return std::nullopt;
+}
+#endif
+
+// sorted keys, allows prefix search during completion
+template <typename T>
+auto mappingKeys(std::unordered_map<std::string, T> const& mapping) -> std::vector<std::string> {
+    auto keys = std::vector<std::string>{};
+    for (auto const& [key, value] : mapping) {
+        keys.push_back(key);
+    }
+    std::ranges::sort(keys);
+    return keys;
+}
+
+template <typename T>
+constexpr bool IsListType = HasPushBack<T> && !std::same_as<std::string, T> && !std::same_as<std::filesystem::path, T>;
+
+// the members of Argument<T, ...> that are needed to parse a value
+template <typename T>
+struct ValueTarget {
+    T*                                value;
+    std::optional<std::string> const* suffix;
+    Mapping<T> const*                 mapping;
 };
 
+// ArgumentBase::fromString of single values and lists
+// only two pointers, so std::function stores it without allocating
+template <typename T>
+struct ValueParser {
+    ArgumentBase*         arg;
+    ValueTarget<T> const* target;
+
+    void operator()(std::string_view s) const {
+        auto const& [value, suffix, mapping] = *target;
+        if constexpr (IsListType<T>) {
+            if (*mapping) {
+                throw std::runtime_error("Type can't use mapping");
+            }
+            using value_type = typename T::value_type;
+            if constexpr (std::is_arithmetic_v<value_type>) {
+                value->push_back(parseFromString<value_type>(stripSuffix(s, *suffix)));
+            } else {
+                value->push_back(parseFromString<value_type>(s));
+            }
+        } else {
+            if (*mapping) {
+                auto iter = (*mapping)->find(std::string{s});
+                if (iter == (*mapping)->end()) {
+                    throwInvalidValue(s, *arg->mapping);
+                }
+                *value = iter->second;
+            } else if constexpr (std::is_arithmetic_v<T>) {
+                *value = parseFromString<T>(stripSuffix(s, *suffix));
+            } else {
+                *value = parseFromString<T>(s);
+            }
+            arg->fromString = nullptr; // single value, no further values accepted
+        }
+    }
+};
+
+// ArgumentBase::storeValue of reloadable values, publishes the parsed value (see reload.h)
+template <typename T>
+struct ReloadableStorer {
+    ArgumentBase*                     arg;
+    ValueTarget<Reloadable<T>> const* target;
+
+    void operator()(std::string_view s) const {
+        auto const& [value, suffix, mapping] = *target;
+        if (*mapping) {
+            auto iter = (*mapping)->find(std::string{s});
+            if (iter == (*mapping)->end()) {
+                throwInvalidValue(s, *arg->mapping);
+            }
+            value->store(iter->second.load());
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            value->store(parseFromString<T>(stripSuffix(s, *suffix)));
+        } else {
+            value->store(parseFromString<T>(s));
+        }
+    }
+};
+
+// ArgumentBase::fromString of reloadable values
+template <typename T>
+struct ReloadableParser {
+    ReloadableStorer<T> store;
+
+    void operator()(std::string_view s) const {
+        store(s);
+        store.arg->fromString = nullptr; // single value, no further values accepted
+    }
+};
+
+// ArgumentBase::fromString of invocable values, stores the parsed result instead of evaluating the invocable
+template <typename R>
+struct LazyParser {
+    ArgumentBase* arg;
+    LazyValue<R>* lazy;
+
+    void operator()(std::string_view s) const {
+        lazy->set(parseFromString<R>(s));
+        arg->fromString = nullptr; // single value, no further values accepted
+    }
+};
+
+// ArgumentBase::toString of single values
+template <typename T>
+struct ValuePrinter {
+    T const*          value;
+    Mapping<T> const* mapping;
+
+    auto operator()() const -> std::optional<std::string> {
+        if (*mapping) {
+            for (auto const& [key, v] : **mapping) {
+                if (v == *value) return key;
+            }
+            return "unknown";
+        }
+        if constexpr (std::same_as<bool, T>) {
+            return *value?"true":"false";
+        } else if constexpr (std::is_arithmetic_v<T>) {
+            return std::to_string(*value);
+        } else if constexpr (std::same_as<std::string, T>) {
+            if (value->empty()) return "\"\"";
+            return *value;
+        } else if constexpr (std::same_as<std::filesystem::path, T>) {
+            if (value->string() == "") return "\"\"";
+            return value->string();
+        } else {
+            static_assert(std::is_enum_v<T>);
+            using UT = std::underlying_type_t<T>;
+            return std::to_string(static_cast<UT>(*value));
+        }
+    }
+};
+
+// values that can be stored in a snapshot: copied as in memory, strings and lists with their size
+template <typename T>
+constexpr bool IsBinaryScalar = std::is_arithmetic_v<T> || std::is_enum_v<T>
+                                || std::same_as<std::string, T> || std::same_as<std::filesystem::path, T>;
+
+template <typename T>
+constexpr bool IsBinaryValue = []() {
+    if constexpr (IsListType<T>) {
+        return IsBinaryScalar<typename T::value_type>;
+    } else {
+        return IsBinaryScalar<T>;
+    }
+}();
+
+template <typename T>
+void writeBinaryValue(std::string& out, T const& value) {
+    if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        out.append(reinterpret_cast<char const*>(&value), sizeof(T));
+    } else if constexpr (std::same_as<std::string, T>) {
+        writeBinaryValue(out, uint64_t{value.size()});
+        out.append(value);
+    } else if constexpr (std::same_as<std::filesystem::path, T>) {
+        writeBinaryValue(out, value.string());
+    } else {
+        writeBinaryValue(out, uint64_t{value.size()});
+        for (auto const& v : value) {
+            writeBinaryValue<typename T::value_type>(out, v);
+        }
+    }
+}
+
+// consumes the value from the front of in
+template <typename T>
+void readBinaryValue(std::string_view& in, T& value) {
+    if constexpr (std::is_arithmetic_v<T> || std::is_enum_v<T>) {
+        if (in.size() < sizeof(T)) throwTruncatedSnapshot();
+        std::memcpy(&value, in.data(), sizeof(T));
+        in.remove_prefix(sizeof(T));
+    } else if constexpr (std::same_as<std::string, T> || std::same_as<std::filesystem::path, T>) {
+        auto size = uint64_t{};
+        readBinaryValue(in, size);
+        if (in.size() < size) throwTruncatedSnapshot();
+        value = std::string{in.substr(0, size)};
+        in.remove_prefix(size);
+    } else {
+        auto size = uint64_t{};
+        readBinaryValue(in, size);
+        if (in.size() < size) throwTruncatedSnapshot(); // each element takes at least one byte
+        value.clear();
+        for (uint64_t i{0}; i < size; ++i) {
+            auto v = typename T::value_type{};
+            readBinaryValue(in, v);
+            value.push_back(std::move(v));
+        }
+    }
+}
+
+// ArgumentBase::saveValue and loadValue
+template <typename T>
+struct ValueSaver {
+    T const* value;
+
+    void operator()(std::string& out) const {
+        writeBinaryValue(out, *value);
+    }
+};
+
+template <typename T>
+struct ValueLoader {
+    T* value;
+
+    void operator()(std::string_view& in) const {
+        readBinaryValue(in, *value);
+    }
+};
+
+template <typename T>
+struct ReloadableSaver {
+    Reloadable<T> const* value;
+
+    void operator()(std::string& out) const {
+        writeBinaryValue(out, value->load());
+    }
+};
+
+template <typename T>
+struct ReloadableLoader {
+    Reloadable<T>* value;
+
+    void operator()(std::string_view& in) const {
+        auto v = T{};
+        readBinaryValue(in, v);
+        value->store(std::move(v));
+    }
+};
+
+// invocable values: the stored result, if there is one
+template <typename R>
+struct LazySaver {
+    LazyValue<R> const* lazy;
+
+    void operator()(std::string& out) const {
+        auto value = lazy->tryGet();
+        out.push_back(value?1:0);
+        if (value) writeBinaryValue(out, *value);
+    }
+};
+
+template <typename R>
+struct LazyLoader {
+    LazyValue<R>* lazy;
+
+    void operator()(std::string_view& in) const {
+        if (in.empty()) throwTruncatedSnapshot();
+        auto hasValue = in[0] != 0;
+        in.remove_prefix(1);
+        if (hasValue) {
+            auto value = R{};
+            readBinaryValue(in, value);
+            lazy->set(std::move(value));
+        }
+    }
+};
+
+template <typename T>
+auto makeSaveValue(T const& value, LazyStorage<T> const& lazy) -> std::function<void(std::string&)> {
+    if constexpr (IsBinaryValue<T>) {
+        return ValueSaver<T>{&value};
+    } else if constexpr (IsReloadable<T>) {
+        if constexpr (IsBinaryValue<typename T::value_type>) {
+            return ReloadableSaver<typename T::value_type>{&value};
+        }
+    } else if constexpr (std::is_invocable_v<T>) {
+        using R = std::decay_t<std::invoke_result_t<T>>;
+        if constexpr (IsBinaryValue<R>) {
+            return LazySaver<R>{&lazy};
+        }
+    }
+    return {};
+}
+
+template <typename T>
+auto makeLoadValue(T& value, LazyStorage<T>& lazy) -> std::function<void(std::string_view&)> {
+    if constexpr (IsBinaryValue<T>) {
+        return ValueLoader<T>{&value};
+    } else if constexpr (IsReloadable<T>) {
+        if constexpr (IsBinaryValue<typename T::value_type>) {
+            return ReloadableLoader<typename T::value_type>{&value};
+        }
+    } else if constexpr (std::is_invocable_v<T>) {
+        using R = std::decay_t<std::invoke_result_t<T>>;
+        if constexpr (IsBinaryValue<R>) {
+            return LazyLoader<R>{&lazy};
+        }
+    }
+    return {};
+}
+
+// ArgumentBase::toString of reloadable values, prints the current value
+template <typename T>
+struct ReloadablePrinter {
+    Reloadable<T> const*             value;
+    Mapping<Reloadable<T>> const*    mapping;
+
+    auto operator()() const -> std::optional<std::string> {
+        if (*mapping) {
+            for (auto const& [key, v] : **mapping) {
+                if (v.load() == value->load()) return key;
+            }
+            return "unknown";
+        }
+        static Mapping<T> const noMapping{};
+        auto current = value->snapshot();
+        return ValuePrinter<T>{current.get(), &noMapping}();
+    }
+};
+
+template <typename T>
+auto makeFromString(ArgumentBase& arg, ValueTarget<T> const& target, LazyStorage<T>& lazy) -> std::function<void(std::string_view)> {
+    if constexpr (std::same_as<std::nullptr_t, T>) {
+        return {};
+    } else if constexpr (IsReloadable<T>) {
+        return ReloadableParser<typename T::value_type>{{&arg, &target}};
+    } else if constexpr (std::is_arithmetic_v<T> || std::same_as<std::string, T> || std::same_as<std::filesystem::path, T>
+                         || std::is_enum_v<T> || HasPushBack<T>) {
+        return ValueParser<T>{&arg, &target};
+    } else if constexpr (std::is_invocable_v<T>) {
+        return LazyParser<std::decay_t<std::invoke_result_t<T>>>{&arg, &lazy};
+    } else {
+        []<bool type_available = false> {
+            static_assert(type_available, "Type can't be used as a value type in clice::Argument");
+        }();
+    }
+}
+
+template <typename T>
+auto makeToString(T const& value, Mapping<T> const& mapping) -> std::function<std::optional<std::string>()> {
+    if constexpr (std::same_as<std::nullptr_t, T> || IsListType<T> || std::is_invocable_v<T>) {
+        return &noValueString;
+    } else if constexpr (IsReloadable<T>) {
+        return ReloadablePrinter<typename T::value_type>{&value, &mapping};
+    } else if constexpr (std::is_arithmetic_v<T> || std::same_as<std::string, T> || std::same_as<std::filesystem::path, T>
+                         || std::is_enum_v<T>) {
+        return ValuePrinter<T>{&value, &mapping};
+    } else {
+        []<bool type_available = false> {
+            static_assert(type_available, "Type can't be used as a value type in clice::Argument");
+        }();
+    }
+}
+
 template <typename T = std::nullptr_t, typename CBType = std::function<void()>, typename ...TParents>
 struct Argument {
     Argument<TParents...>*     parent{};
@@ -134,14 +663,17 @@ struct Argument {
     std::string                id{}; // some identification, like <threadNbr>
     bool                       symlink{};
     std::string                desc{};
+    std::function<void()>      lazyChildren{}; // registers the child arguments once the command is selected
     bool                       isSet{};   // (not for the user)
     T                          value{};
+    bool                       prefetch{}; // evaluate an invocable value on a background thread during clice::parse
     std::optional<std::string> suffix{};  // require a suffix like "b" (bytes) or "s" (seconds)
-    mutable std::any           anyType{}; // used if T is a callback (not for the user)
+    LazyStorage<T>             lazy{};    // result if T is a callback (not for the user)
     std::function<std::vector<std::string>()> completion{};
+    std::optional<CompletionCache>                    completion_cache{}; // caches results of '.completion' on disk
     CBType                                            cb{};
     size_t                                            cb_priority{100}; // lower priorities will be triggered before larger ones
-    std::optional<std::unordered_map<std::string, T>> mapping{};
+    Mapping<T>                                        mapping{};
     std::unordered_set<std::string>                   tags{};  // known tags "required"
 
     operator bool() const {
@@ -152,11 +684,7 @@ struct Argument {
         requires (!std::same_as<T, std::nullptr_t>)
     {
         if constexpr (std::is_invocable_v<T>) {
-            using R = std::decay_t<decltype(value())>;
-            if (!anyType.has_value()) {
-                anyType = value();
-            }
-            return *std::any_cast<R>(&anyType);
+            return lazy.get(value);
         } else {
             return value;
         }
@@ -168,7 +696,8 @@ struct Argument {
     }
 
     struct CTor {
-        ArgumentBase arg;
+        ArgumentBase   arg;
+        ValueTarget<T> target;
         static auto detectType() -> std::type_index {
             if constexpr (std::is_invocable_v<T>) {
                 // Get the type_index of a lambda
@@ -177,43 +706,39 @@ struct Argument {
             return std::type_index(typeid(T));
         };
         CTor(Argument& desc)
-            : arg { desc.parent?&desc.parent->storage.arg:nullptr, detectType()}
+            : arg { desc.parent?&desc.parent->storage.arg:nullptr, detectType(), TypeTraits<T>::descriptor}
+            , target{&desc.value, &desc.suffix, &desc.mapping}
         {
             arg.args    = desc.args;
             arg.env     = desc.env;
             arg.id      = desc.id;
             arg.symlink = desc.symlink;
             arg.desc    = desc.desc;
+            arg.lazyChildren = desc.lazyChildren;
             arg.validateOrThrowInvariant();
+            if (arg.symlink) {
+                registerSymlink(arg);
+            }
 
             if (desc.completion) {
-                arg.completion_fn = desc.completion;
-            } else {
-                if constexpr (std::same_as<std::filesystem::path, T>) {
-                    arg.completion = " -f ";
-                } else if (desc.mapping) {
-                    std::string str;
-                    for (auto [key, value] : *desc.mapping) {
-                        str += key + "\n";
-                    }
-                    arg.completion = str;
-                }
+                arg.completion_fn    = desc.completion;
+                arg.completion_cache = desc.completion_cache;
             }
             if (desc.mapping) {
-                auto v = std::vector<std::string>{};
-                for (auto const& [key, value] : *desc.mapping) {
-                    v.push_back(key);
-                }
-                arg.mapping = v;
+                arg.mapping = mappingKeys(*desc.mapping);
             }
             arg.tags = desc.tags;
 
-            bool isMulti = HasPushBack<T> && !std::same_as<std::string, T> && !std::same_as<std::filesystem::path, T>;
-            if (isMulti) {
+            if (arg.type->kind == TypeKind::List) {
                 arg.tags.insert("multi");
             }
+            if constexpr (IsReloadable<T>) {
+                arg.tags.insert("reloadable");
+                arg.storeValue = ReloadableStorer<typename T::value_type>{&arg, &target};
+            }
             arg.init = [&]() {
                 desc.isSet = true;
+                arg.isSet  = true;
                 if constexpr (requires() {
                     { desc.cb() };
                 }) {
@@ -226,129 +751,24 @@ struct Argument {
                     };
                 }
                 arg.cb_priority = desc.cb_priority;
-                if constexpr (std::same_as<std::nullptr_t, T>) {
-                } else if constexpr (std::is_arithmetic_v<T>) {
-                    arg.fromString = [&](std::string_view s) {
-                        if (desc.mapping) {
-                            if (!desc.mapping->contains(std::string{s})) {
-                                std::string validValues{};
-                                for (auto [key, value] : *desc.mapping) {
-                                    validValues += key + ", ";
-                                }
-                                if (validValues.size() > 2) {
-                                    validValues.pop_back();
-                                    validValues.pop_back();
-                                }
-                                throw std::runtime_error{"invalid value \"" + std::string{s} + "\". Valid values are: [ " + validValues + " ]"};
-                            }
-                            desc.value = desc.mapping->at(std::string{s});
-                        } else {
-                            if (desc.suffix) {
-                                if (!s.ends_with(desc.suffix.value())) {
-                                    throw std::runtime_error{"expected the suffix \"" + desc.suffix.value() + "\""};
-                                }
-                                auto t = s.substr(0, s.size() - desc.suffix->size());
-                                desc.value = parseFromString<T>(t);
-                            } else {
-                                desc.value = parseFromString<T>(s);
-                            }
-                        }
-                        arg.fromString = nullptr;
-                    };
-                } else if constexpr (   std::same_as<std::string, T>
-                                     || std::same_as<std::filesystem::path, T>
-                                     || std::is_enum_v<T>) {
-                    arg.fromString = [&](std::string_view s) {
-                        if (desc.mapping) {
-                            if (!desc.mapping->contains(std::string{s})) {
-                                std::string validValues{};
-                                for (auto [key, value] : *desc.mapping) {
-                                    validValues += key + ", ";
-                                }
-                                if (validValues.size() > 2) {
-                                    validValues.pop_back();
-                                    validValues.pop_back();
-                                }
-                                throw std::runtime_error{"invalid value \"" + std::string{s} + "\". Valid values are: [ " + validValues + " ]"};
-                            }
-
-                            desc.value = desc.mapping->at(std::string{s});
-                        } else {
-                            desc.value = parseFromString<T>(s);
-                        }
-                        arg.fromString = nullptr;
-                    };
-                } else if constexpr (HasPushBack<T>) {
-                    arg.fromString = [&](std::string_view s) {
-                        if (desc.mapping) {
-                            throw std::runtime_error("Type can't use mapping");
-                        } else {
-                            using value_type = typename T::value_type;
-                            if constexpr (std::integral<value_type> || std::floating_point<value_type>) {
-                                if (desc.suffix) {
-                                    if (!s.ends_with(desc.suffix.value())) {
-                                        throw std::runtime_error{"expected the suffix \"" + desc.suffix.value() + "\""};
-                                    }
-                                    auto t = s.substr(0, s.size() - desc.suffix->size());
-                                    desc.value.push_back(parseFromString<value_type>(t));
-                                } else {
-                                    desc.value.push_back(parseFromString<value_type>(s));
-                                }
-                            } else {
-                                desc.value.push_back(parseFromString<value_type>(s));
-                            }
-                        }
-                    };
-                } else if constexpr (std::is_invocable_v<T>) {
-                    arg.fromString = [&](std::string_view s) {
-                        using RT = std::invoke_result_t<T>;
-                        desc.anyType = parseFromString<RT>(s);
-                    };
-                } else {
-                    []<bool type_available = false> {
-                        static_assert(type_available, "Type can't be used as a value type in clice::Argument");
-                    }();
-                }
+                arg.fromString  = makeFromString(arg, target, desc.lazy);
             };
-            arg.toString = [&]() -> std::optional<std::string> {
-                auto reverseMapping = [&](auto v) -> std::string {
-                    for (auto const& [key, value] : *desc.mapping) {
-                        if (value == v) return key;
-                    }
-                    return "unknown";
+            if constexpr (IsListType<T>) {
+                arg.clearValue = [&desc]() {
+                    desc.value.clear();
                 };
-
-                if constexpr (std::same_as<std::nullptr_t, T>) {
-                    return std::nullopt;
-                } else if constexpr (std::same_as<bool, T>) {
-                    if (desc.mapping) return reverseMapping(desc.value);
-                    return desc.value?"true":"false";
-                } else if constexpr (std::is_arithmetic_v<T>) {
-                    if (desc.mapping) return reverseMapping(desc.value);
-                    return std::to_string(desc.value);
-                } else if constexpr (std::same_as<std::string, T>) {
-                    if (desc.mapping) return reverseMapping(desc.value);
-                    if (desc.value.empty()) return "\"\"";
-                    return desc.value;
-                } else if constexpr (std::same_as<std::filesystem::path, T>) {
-                    if (desc.mapping) return reverseMapping(desc.value);
-                    if (desc.value.string() == "") return "\"\"";
-                    return desc.value.string();
-                } else if constexpr (std::is_enum_v<T>) {
-                    if (desc.mapping) return reverseMapping(desc.value);
-                    using UT = std::underlying_type_t<T>;
-                    return std::to_string(static_cast<UT>(desc.value));
-                } else if constexpr (HasPushBack<T>) {
-                    return std::nullopt;
-                } else if constexpr (std::is_invocable_v<T>) {
-                    return std::nullopt;
-                } else {
-                    []<bool type_available = false> {
-                        static_assert(type_available, "Type can't be used as a value type in clice::Argument");
-                    }();
+            }
+            arg.toString  = makeToString(desc.value, desc.mapping);
+            arg.saveValue = makeSaveValue(desc.value, desc.lazy);
+            arg.loadValue = makeLoadValue(desc.value, desc.lazy);
+            if constexpr (std::is_invocable_v<T>) {
+                if (desc.prefetch) {
+                    arg.prefetchValue = [&desc]() {
+                        desc.lazy.evaluate(desc.value);
+                    };
+                    Register::getInstance().prefetch.push_back(&arg);
                 }
-            };
-
+            }
         }
     } storage{*this};
 };
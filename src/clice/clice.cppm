@@ -0,0 +1,78 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+
+/**
+ * C++20 module interface of clice (optional, see CLICE_BUILD_MODULE)
+ *
+ * Wraps the headers, so 'import clice;' provides the same API as '#include <clice/clice.h>'.
+ * The standard library, fmt and tdl headers are parsed once when the module is built
+ * instead of in every translation unit.
+ */
+module;
+
+#include "clice.h"
+
+export module clice;
+
+export namespace clice {
+    // arguments
+    using clice::argv0;
+    using clice::Argument;
+    using clice::ArgumentBase;
+    using clice::ArgumentList;
+    using clice::CompletionCache;
+    using clice::ListOfStrings;
+    using clice::Register;
+    using clice::Reloadable;
+
+    // value types
+    using clice::CompletionHint;
+    using clice::ElementKind;
+    using clice::TypeDescriptor;
+    using clice::TypeKind;
+    using clice::TypeTraits;
+
+    // parsing
+    using clice::parse;
+    using clice::parseSingleDash;
+    using clice::waitPrefetch;
+    using clice::Parse;
+    using clice::ParseReport;
+    using clice::parseReportSink;
+    using clice::enableProfile;
+    using clice::Profile;
+    using clice::ProfileEntry;
+    using clice::ProfileFormat;
+    using clice::renderProfile;
+
+    // snapshots
+    using clice::decodeSnapshot;
+    using clice::encodeSnapshot;
+    using clice::restoreSnapshot;
+    using clice::saveSnapshot;
+
+    // config files
+    using clice::applyConfig;
+    using clice::loadConfig;
+
+    // reloading
+    using clice::reload;
+    using clice::reloadConfig;
+
+    // help
+    using clice::EmbeddedHelp;
+    using clice::generateHelp;
+    using clice::generatePartialSynopsis;
+    using clice::generateSplitSynopsis;
+    using clice::generateSynopsis;
+    using clice::printHelp;
+    using clice::registerEmbeddedHelp;
+    using clice::renderHelp;
+
+    // tool descriptions
+    using clice::generateSchema;
+    using clice::writeSchema;
+#ifdef CLICE_USE_TDL
+    using clice::generateCWL;
+#endif
+}
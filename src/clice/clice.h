@@ -5,3 +5,4 @@
 #include "parse.h"
 #include "generateCWL.h"
 #include "generateHelp.h"
+#include "reload.h"
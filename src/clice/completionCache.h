@@ -0,0 +1,200 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fmt/format.h>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <vector>
+
+#if __has_include(<unistd.h>) && __has_include(<poll.h>) && __has_include(<sys/wait.h>)
+    #define CLICE_COMPLETION_CACHE_FORK
+    #include <fcntl.h>
+    #include <poll.h>
+    #include <sys/wait.h>
+    #include <unistd.h>
+#endif
+
+namespace clice {
+
+/**
+ * On-disk cache for '.completion' results
+ *
+ * Results are stored in $XDG_CACHE_HOME/clice (or ~/.cache/clice), one file per binary and argument.
+ * '.completion' does not know the word being completed, so the unfiltered results are cached
+ * and shared between all prefixes.
+ * Cached results younger than 'ttl' are used directly. Otherwise '.completion' is run in a child
+ * process, if it doesn't finish within 'budget' the stale results (or none) are returned and the
+ * child keeps refreshing the cache in the background.
+ */
+
+CLICE_INLINE auto completionCacheDir() -> std::optional<std::filesystem::path>;
+CLICE_INLINE auto completionCacheBinary() -> std::filesystem::path;
+CLICE_INLINE auto completionCacheFile(ArgumentBase const& arg) -> std::optional<std::filesystem::path>;
+CLICE_INLINE auto readCompletionCache(std::filesystem::path const& path) -> std::optional<std::vector<std::string>>;
+CLICE_INLINE void writeCompletionCache(std::filesystem::path const& path, std::vector<std::string> const& values);
+CLICE_INLINE auto completionCacheAge(std::filesystem::path const& path) -> std::optional<std::chrono::seconds>;
+CLICE_INLINE auto completionValues(ArgumentBase const& arg) -> std::vector<std::string>;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE auto completionCacheDir() -> std::optional<std::filesystem::path> {
+    if (auto ptr = std::getenv("XDG_CACHE_HOME"); ptr && *ptr) {
+        return std::filesystem::path{ptr} / "clice";
+    }
+    if (auto ptr = std::getenv("HOME"); ptr && *ptr) {
+        return std::filesystem::path{ptr} / ".cache" / "clice";
+    }
+    return std::nullopt;
+}
+
+// path of the running binary, used as part of the cache key
+CLICE_INLINE auto completionCacheBinary() -> std::filesystem::path {
+    auto ec = std::error_code{};
+    if (auto path = std::filesystem::read_symlink("/proc/self/exe", ec); !ec) {
+        return path;
+    }
+    auto path = std::filesystem::absolute(argv0, ec);
+    return ec?std::filesystem::path{argv0}:path;
+}
+
+CLICE_INLINE auto completionCacheFile(ArgumentBase const& arg) -> std::optional<std::filesystem::path> {
+    auto dir = completionCacheDir();
+    if (!dir) return std::nullopt;
+
+    // key: binary + path of the argument in the argument tree
+    auto key = completionCacheBinary().string();
+    for (auto a = &arg; a; a = a->parent) {
+        key += " " + (a->args.empty()?a->id:a->args[0]);
+    }
+    // FNV-1a
+    auto hash = uint64_t{14695981039346656037ull};
+    for (auto c : key) {
+        hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+    }
+    return *dir / fmt::format("completion-{:016x}", hash);
+}
+
+CLICE_INLINE auto readCompletionCache(std::filesystem::path const& path) -> std::optional<std::vector<std::string>> {
+    auto ifs = std::ifstream{path};
+    auto line = std::string{};
+    if (!std::getline(ifs, line) || line != "clice-completion-cache 1") {
+        return std::nullopt;
+    }
+    auto values = std::vector<std::string>{};
+    while (std::getline(ifs, line)) {
+        values.push_back(line);
+    }
+    return values;
+}
+
+// writes to a temporary file first, so readers never see partial results
+CLICE_INLINE void writeCompletionCache(std::filesystem::path const& path, std::vector<std::string> const& values) {
+    auto ec  = std::error_code{};
+    auto tmp = path;
+    tmp += fmt::format(".{}", std::chrono::steady_clock::now().time_since_epoch().count());
+    std::filesystem::create_directories(path.parent_path(), ec);
+    {
+        auto ofs = std::ofstream{tmp};
+        ofs << "clice-completion-cache 1\n";
+        for (auto const& v : values) {
+            ofs << v << "\n";
+        }
+        if (!ofs) {
+            std::filesystem::remove(tmp, ec);
+            return;
+        }
+    }
+    std::filesystem::rename(tmp, path, ec);
+    if (ec) {
+        std::filesystem::remove(tmp, ec);
+    }
+}
+
+// age of the cache file, std::nullopt if the file is missing or older than the binary
+CLICE_INLINE auto completionCacheAge(std::filesystem::path const& path) -> std::optional<std::chrono::seconds> {
+    auto ec    = std::error_code{};
+    auto mtime = std::filesystem::last_write_time(path, ec);
+    if (ec) return std::nullopt;
+    if (auto binTime = std::filesystem::last_write_time(completionCacheBinary(), ec); !ec && binTime > mtime) {
+        return std::nullopt;
+    }
+    auto now = std::filesystem::file_time_type::clock::now();
+    return std::chrono::duration_cast<std::chrono::seconds>(now - mtime);
+}
+
+CLICE_INLINE auto completionValues(ArgumentBase const& arg) -> std::vector<std::string> {
+    if (!arg.completion_cache) {
+        return arg.completion_fn();
+    }
+    auto path = completionCacheFile(arg);
+    if (!path) {
+        return arg.completion_fn();
+    }
+
+    auto age   = completionCacheAge(*path);
+    auto stale = age?readCompletionCache(*path):std::nullopt;
+    if (stale && *age < arg.completion_cache->ttl) {
+        return *stale;
+    }
+
+#ifdef CLICE_COMPLETION_CACHE_FORK
+    // refresh in a detached process, the pipe is closed when it terminates
+    int fds[2];
+    if (pipe(fds) != 0) {
+        return arg.completion_fn();
+    }
+    auto pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return arg.completion_fn();
+    }
+    if (pid == 0) {
+        // double fork: the grandchild refreshes the cache and is reparented to init,
+        // so no zombie is left when the parent returns before the refresh finished
+        if (fork() != 0) {
+            _exit(0);
+        }
+        // detach from the shell waiting for the output of the completion
+        close(fds[0]);
+        auto devnull = open("/dev/null", O_RDWR);
+        dup2(devnull, STDIN_FILENO);
+        dup2(devnull, STDOUT_FILENO);
+        dup2(devnull, STDERR_FILENO);
+        setsid();
+        try {
+            writeCompletionCache(*path, arg.completion_fn());
+        } catch (...) {}
+        _exit(0);
+    }
+    close(fds[1]);
+    waitpid(pid, nullptr, 0); // exits right after forking the grandchild
+    auto pfd     = pollfd{.fd = fds[0], .events = POLLIN, .revents = 0};
+    auto timeout = static_cast<int>(arg.completion_cache->budget.count());
+    auto ready   = poll(&pfd, 1, timeout) > 0;
+    close(fds[0]);
+    if (!ready) {
+        // over budget: the grandchild keeps running and refreshes the cache for the next request
+        return stale.value_or(std::vector<std::string>{});
+    }
+    if (auto values = readCompletionCache(*path)) {
+        return *values;
+    }
+    return stale.value_or(std::vector<std::string>{});
+#else
+    auto values = arg.completion_fn();
+    writeCompletionCache(*path, values);
+    return values;
+#endif
+}
+#endif
+
+}
@@ -0,0 +1,24 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+/**
+ * Header-only or compiled library
+ *
+ * By default clice is header-only. With CLICE_COMPILED_LIB defined (CMake: -DCLICE_BUILD_LIB=ON,
+ * target clice::lib) the non-template functions are compiled once into libclice
+ * (src/libclice/clice.cpp) and the headers only declare them.
+ *
+ * CLICE_INLINE marks these functions, their definitions are guarded by CLICE_DEFINITIONS.
+ */
+#if defined(CLICE_COMPILED_LIB) || defined(CLICE_BUILDING_LIB)
+    #define CLICE_INLINE
+#else
+    #define CLICE_INLINE inline
+#endif
+
+#if defined(CLICE_COMPILED_LIB) && !defined(CLICE_BUILDING_LIB)
+    #define CLICE_DEFINITIONS 0
+#else
+    #define CLICE_DEFINITIONS 1
+#endif
@@ -0,0 +1,231 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+#include "config.h"
+#include "parseString.h"
+
+#include <filesystem>
+#include <fmt/format.h>
+#include <functional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#ifdef _WIN32
+    #include <fstream>
+    #include <sstream>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+namespace clice {
+
+/**
+ * Config files (INI/TOML-lite)
+ *
+ *   # comment (also ';' at the start of a line)
+ *   threads = 8          # sets "--threads" (or "-threads", "threads"), leading dashes may be omitted
+ *   verbose = true       # flags are set by true and left unset by false
+ *   name    = "a value"  # surrounding quotes are removed, no escape sequences
+ *   [build]              # children of the command "build", nested commands as [build.release]
+ *   jobs    = 4
+ *
+ * Comments after a value must be separated by whitespace ("a#b" is a value).
+ *
+ * Values go through the same fromString as values on the command line. Config files are read
+ * before the environment variables and argv, so the precedence is CLI > env > config > default.
+ * Repeating a key of a list argument appends a value, like repeating the option on the command line.
+ * Values of a list given by environment variables or argv replace the values of the config file.
+ *
+ * loadConfig memory-maps the file, keys and values are views into the mapping.
+ */
+struct MappedFile {
+    std::string_view text;
+#ifdef _WIN32
+    std::string      content;
+#else
+    void*            data{};
+    size_t           size{};
+#endif
+
+    explicit MappedFile(std::filesystem::path const& path);
+    ~MappedFile();
+    MappedFile(MappedFile const&) = delete;
+    auto operator=(MappedFile const&) -> MappedFile& = delete;
+};
+
+CLICE_INLINE auto trimConfigWhitespace(std::string_view str) -> std::string_view;
+CLICE_INLINE auto visitConfig(std::string_view text, std::string_view source, std::function<bool(ArgumentBase&, std::string_view)> const& apply) -> size_t;
+CLICE_INLINE auto applyConfig(std::string_view text, std::string_view source = "config") -> size_t;
+CLICE_INLINE auto loadConfig(std::filesystem::path const& path) -> size_t;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE MappedFile::MappedFile(std::filesystem::path const& path) {
+#ifdef _WIN32
+    auto ifs = std::ifstream{path, std::ios::binary};
+    if (!ifs) {
+        throw std::runtime_error{"can't open config file " + path.string()};
+    }
+    auto ss = std::stringstream{};
+    ss << ifs.rdbuf();
+    content = std::move(ss).str();
+    text    = content;
+#else
+    auto fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        throw std::runtime_error{"can't open config file " + path.string()};
+    }
+    struct stat st{};
+    if (::fstat(fd, &st) != 0) {
+        ::close(fd);
+        throw std::runtime_error{"can't stat config file " + path.string()};
+    }
+    size = static_cast<size_t>(st.st_size);
+    if (size > 0) {
+        data = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data == MAP_FAILED) {
+            ::close(fd);
+            throw std::runtime_error{"can't map config file " + path.string()};
+        }
+        text = std::string_view{static_cast<char const*>(data), size};
+    }
+    ::close(fd);
+#endif
+}
+
+CLICE_INLINE MappedFile::~MappedFile() {
+#ifndef _WIN32
+    if (data) {
+        ::munmap(data, size);
+    }
+#endif
+}
+
+CLICE_INLINE auto trimConfigWhitespace(std::string_view str) -> std::string_view {
+    auto const whitespace = std::string_view{" \t\r"};
+    auto first = str.find_first_not_of(whitespace);
+    if (first == std::string_view::npos) return {};
+    auto last = str.find_last_not_of(whitespace);
+    return str.substr(first, last - first + 1);
+}
+
+/**
+ * Calls apply for every key of a config file, with the argument and the value
+ * source: name used in error messages, also for exceptions thrown by apply
+ * returns the number of keys for which apply returned true
+ */
+CLICE_INLINE auto visitConfig(std::string_view text, std::string_view source, std::function<bool(ArgumentBase&, std::string_view)> const& apply) -> size_t {
+    // arguments by alias (with and without leading dashes), per command, built on first use
+    using Index = std::unordered_map<std::string_view, ArgumentBase*>;
+    auto indices = std::unordered_map<ArgumentBase const*, Index>{};
+    auto index = [&](ArgumentBase const* command) -> Index const& {
+        auto [iter, inserted] = indices.try_emplace(command);
+        if (inserted) {
+            if (command) command->expandChildren();
+            auto const& args = command?command->children:Register::getInstance().arguments;
+            for (auto arg : args) {
+                for (auto const& alias : arg->args) {
+                    iter->second.try_emplace(alias, arg);
+                    auto name = std::string_view{alias};
+                    while (name.starts_with('-')) name.remove_prefix(1);
+                    iter->second.try_emplace(name, arg);
+                }
+            }
+        }
+        return iter->second;
+    };
+
+    auto lineNbr = size_t{};
+    auto fail = [&](std::string_view msg) {
+        throw std::runtime_error{fmt::format("{}:{}: {}", source, lineNbr, msg)};
+    };
+
+    ArgumentBase* command{};
+    auto count   = size_t{};
+    while (!text.empty()) {
+        ++lineNbr;
+        auto end  = text.find('\n');
+        auto line = trimConfigWhitespace(text.substr(0, end));
+        text = (end == std::string_view::npos)?std::string_view{}:text.substr(end+1);
+
+        if (line.empty() or line[0] == '#' or line[0] == ';') continue;
+
+        // [command.subcommand]
+        if (line[0] == '[') {
+            if (!line.ends_with(']')) fail("missing ']'");
+            auto path = line.substr(1, line.size()-2);
+            command = nullptr;
+            while (!path.empty()) {
+                auto dot  = path.find('.');
+                auto name = trimConfigWhitespace(path.substr(0, dot));
+                path = (dot == std::string_view::npos)?std::string_view{}:path.substr(dot+1);
+                auto const& idx = index(command);
+                auto iter = idx.find(name);
+                if (iter != idx.end()) iter->second->expandChildren();
+                if (iter == idx.end() or iter->second->children.empty()) {
+                    fail(fmt::format("unknown command \"{}\"", name));
+                }
+                command = iter->second;
+            }
+            continue;
+        }
+
+        // key = value
+        auto eq = line.find('=');
+        if (eq == std::string_view::npos) fail("expected \"key = value\"");
+        auto key   = trimConfigWhitespace(line.substr(0, eq));
+        auto value = trimConfigWhitespace(line.substr(eq+1));
+        if (value.starts_with('"')) {
+            auto close = value.find('"', 1);
+            if (close == std::string_view::npos) fail("missing '\"'");
+            auto rest = trimConfigWhitespace(value.substr(close+1));
+            if (!rest.empty() and rest[0] != '#') fail("unexpected characters after '\"'");
+            value = value.substr(1, close-1);
+        } else if (auto comment = value.find('#'); comment != std::string_view::npos
+                                                    and comment > 0
+                                                    and (value[comment-1] == ' ' or value[comment-1] == '\t')) {
+            value = trimConfigWhitespace(value.substr(0, comment));
+        }
+        auto const& idx = index(command);
+        auto iter = idx.find(key);
+        if (iter == idx.end()) fail(fmt::format("unknown key \"{}\"", key));
+        try {
+            if (apply(*iter->second, value)) ++count;
+        } catch (std::exception const& e) {
+            fail(e.what());
+        }
+    }
+    return count;
+}
+
+/**
+ * Applies the settings of a config file
+ * source: name used in error messages
+ * returns the number of applied keys
+ */
+CLICE_INLINE auto applyConfig(std::string_view text, std::string_view source) -> size_t {
+    return visitConfig(text, source, [](ArgumentBase& arg, std::string_view value) {
+        if (arg.type->kind == TypeKind::Flag) {
+            if (parseFromString<bool>(value)) arg.init();
+        } else {
+            arg.init();
+            arg.fromString(value);
+        }
+        arg.fromConfig = true;
+        return true;
+    });
+}
+
+CLICE_INLINE auto loadConfig(std::filesystem::path const& path) -> size_t {
+    auto file = MappedFile{path};
+    return applyConfig(file.text, path.string());
+}
+#endif
+
+}
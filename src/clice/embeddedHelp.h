@@ -0,0 +1,212 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "generateHelp.h"
+
+#include <cstdio>
+#include <fmt/format.h>
+#include <iostream>
+#include <optional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#if __has_include(<sys/uio.h>) && __has_include(<unistd.h>)
+    #define CLICE_EMBEDDED_HELP_WRITEV
+    #include <sys/uio.h>
+    #include <unistd.h>
+#endif
+
+namespace clice {
+
+/**
+ * Help pages rendered at build time
+ *
+ * clice_embed_help(<target>) (see cmake/clice.cmake) runs the program with
+ * CLICE_GENERATE_EMBEDDED_HELP set, which prints a C++ source file containing the help page
+ * and the help page of every subcommand. This file is compiled into the final program,
+ * '--help' then writes the static text instead of rendering it.
+ * The program name is not known at build time, it is stored as embeddedHelpArgv0 and
+ * replaced when writing.
+ */
+struct EmbeddedHelp {
+    std::string_view command; // space separated path of the subcommand, "" for the full help page
+    std::string_view text;
+};
+
+inline constexpr char embeddedHelpArgv0 = '\x1f';
+inline std::span<EmbeddedHelp const> embeddedHelp;
+
+CLICE_INLINE auto registerEmbeddedHelp(std::span<EmbeddedHelp const> pages) -> bool;
+CLICE_INLINE auto commandPath(ArgumentBase const& command) -> std::string;
+CLICE_INLINE auto embeddedHelpPages() -> std::vector<std::tuple<std::string, std::string>>;
+CLICE_INLINE auto findEmbeddedHelp(ArgumentBase const* command) -> std::optional<std::string_view>;
+CLICE_INLINE auto substituteArgv0(std::string_view text) -> std::string;
+CLICE_INLINE void printEmbeddedHelpSource();
+CLICE_INLINE auto checkEmbeddedHelp() -> bool;
+CLICE_INLINE void printHelp(ArgumentBase const* command);
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE auto registerEmbeddedHelp(std::span<EmbeddedHelp const> pages) -> bool {
+    embeddedHelp = pages;
+    return true;
+}
+
+// e.g. "basic sub"
+CLICE_INLINE auto commandPath(ArgumentBase const& command) -> std::string {
+    auto path = std::string{};
+    for (auto a = &command; a; a = a->parent) {
+        auto name = a->args.empty()?a->id:a->args[0];
+        path = path.empty()?name:(name + " " + path);
+    }
+    return path;
+}
+
+// all help pages as rendered at runtime, with argv0 replaced by embeddedHelpArgv0
+CLICE_INLINE auto embeddedHelpPages() -> std::vector<std::tuple<std::string, std::string>> {
+    auto pages = std::vector<std::tuple<std::string, std::string>>{};
+    auto oldArgv0 = std::exchange(argv0, std::string(1, embeddedHelpArgv0));
+
+    auto out = fmt::memory_buffer{};
+    renderHelp(out);
+    pages.emplace_back("", fmt::to_string(out));
+
+    auto f = [&](auto const& self, ArgumentList const& args) -> void {
+        for (auto arg : args) {
+            arg->expandChildren();
+            if (!arg->children.empty() and !arg->args.empty() and arg->args[0][0] != '-') {
+                out.clear();
+                renderHelp(out, *arg);
+                pages.emplace_back(commandPath(*arg), fmt::to_string(out));
+            }
+            self(self, arg->children);
+        }
+    };
+    f(f, Register::getInstance().arguments);
+
+    argv0 = std::move(oldArgv0);
+    return pages;
+}
+
+CLICE_INLINE auto findEmbeddedHelp(ArgumentBase const* command) -> std::optional<std::string_view> {
+    auto path = command?commandPath(*command):std::string{};
+    for (auto const& page : embeddedHelp) {
+        if (page.command == path) {
+            return page.text;
+        }
+    }
+    return std::nullopt;
+}
+
+// text with embeddedHelpArgv0 replaced by argv0
+CLICE_INLINE auto substituteArgv0(std::string_view text) -> std::string {
+    auto ret = std::string{};
+    for (auto c : text) {
+        if (c == embeddedHelpArgv0) ret += argv0;
+        else ret += c;
+    }
+    return ret;
+}
+
+// prints the C++ source file that embeds all help pages
+CLICE_INLINE void printEmbeddedHelpSource() {
+    auto quote = [](std::string_view text) {
+        auto ret = std::string{"\""};
+        for (auto c : text) {
+            if (c == '\\' || c == '"') {
+                ret += '\\';
+                ret += c;
+            } else if (c == '\n') {
+                ret += "\\n\"\n        \"";
+            } else if (static_cast<unsigned char>(c) < 0x20 || static_cast<unsigned char>(c) >= 0x7f) {
+                ret += fmt::format("\\{:03o}", static_cast<unsigned char>(c));
+            } else {
+                ret += c;
+            }
+        }
+        return ret + "\"";
+    };
+    fmt::print("// generated by clice (CLICE_GENERATE_EMBEDDED_HELP), do not edit\n");
+    fmt::print("#include <clice/embeddedHelp.h>\n\nnamespace {{\nconstexpr clice::EmbeddedHelp pages[] = {{\n");
+    for (auto const& [command, text] : embeddedHelpPages()) {
+        fmt::print("    {{ {},\n        {} }},\n", quote(command), quote(text));
+    }
+    fmt::print("}};\n[[maybe_unused]] auto registered = clice::registerEmbeddedHelp(pages);\n}}\n");
+}
+
+// compares the embedded help pages with the runtime renderer, returns true if they are identical
+CLICE_INLINE auto checkEmbeddedHelp() -> bool {
+    if (embeddedHelp.empty()) {
+        fmt::print(stderr, "no embedded help pages found\n");
+        return false;
+    }
+    bool identical{true};
+    auto pages = embeddedHelpPages();
+    for (auto const& [command, text] : pages) {
+        auto iter = std::ranges::find(embeddedHelp, std::string_view{command}, &EmbeddedHelp::command);
+        if (iter == embeddedHelp.end()) {
+            fmt::print(stderr, "help page of '{}' is not embedded\n", command);
+            identical = false;
+        } else if (iter->text != text) {
+            fmt::print(stderr, "embedded help page of '{}' differs from the runtime help page\n", command);
+            identical = false;
+        }
+    }
+    if (embeddedHelp.size() != pages.size()) {
+        fmt::print(stderr, "embedded help has {} pages, expected {}\n", embeddedHelp.size(), pages.size());
+        identical = false;
+    }
+    return identical;
+}
+
+/**
+ * Prints the help page of command (nullptr: full help page)
+ * Uses the embedded text if available, otherwise renders it.
+ */
+CLICE_INLINE void printHelp(ArgumentBase const* command) {
+    auto text = findEmbeddedHelp(command);
+    if (!text) {
+        auto out = fmt::memory_buffer{};
+        if (command) {
+            renderHelp(out, *command);
+        } else {
+            renderHelp(out);
+        }
+        std::cout.write(out.data(), out.size());
+        return;
+    }
+    std::cout.flush();
+    std::fflush(stdout);
+#ifdef CLICE_EMBEDDED_HELP_WRITEV
+    // single writev call, the static text interleaved with argv0
+    auto iov = std::vector<iovec>{};
+    auto rest = *text;
+    for (auto pos = rest.find(embeddedHelpArgv0); pos != std::string_view::npos; pos = rest.find(embeddedHelpArgv0)) {
+        iov.push_back({const_cast<char*>(rest.data()), pos});
+        iov.push_back({argv0.data(), argv0.size()});
+        rest = rest.substr(pos+1);
+    }
+    iov.push_back({const_cast<char*>(rest.data()), rest.size()});
+    auto expected = size_t{};
+    for (auto const& v : iov) {
+        expected += v.iov_len;
+    }
+    auto written = writev(STDOUT_FILENO, iov.data(), static_cast<int>(iov.size()));
+    if (written >= 0 && static_cast<size_t>(written) == expected) return;
+    // partial write or error, the substituted text is only built in this case
+    auto str = substituteArgv0(*text);
+    if (written >= 0 && static_cast<size_t>(written) < str.size()) {
+        std::fwrite(str.data() + written, 1, str.size() - written, stdout);
+        return;
+    }
+#else
+    auto str = substituteArgv0(*text);
+#endif
+    std::fwrite(str.data(), 1, str.size(), stdout);
+}
+#endif
+
+}
@@ -7,6 +7,7 @@
 #include "Argument.h"
 
 #include <algorithm>
+#include <optional>
 #include <fmt/format.h>
 #include <tdl/tdl.h>
 
@@ -14,80 +15,38 @@
 
 namespace clice {
 
-inline bool isBoolType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(std::nullptr_t)),
-        std::type_index(typeid(bool)),
-    };
-    return s.contains(type);
-}
-
-inline bool isIntType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(int8_t)),
-        std::type_index(typeid(uint8_t)),
-        std::type_index(typeid(int16_t)),
-        std::type_index(typeid(uint16_t)),
-        std::type_index(typeid(int32_t)),
-        std::type_index(typeid(uint32_t)),
-        std::type_index(typeid(int64_t)),
-        std::type_index(typeid(uint64_t)),
-    };
-    return s.contains(type);
-}
-inline bool isFloatType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(float)),
-        std::type_index(typeid(double)),
-    };
-    return s.contains(type);
-}
-inline bool isStringType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(std::string)),
-        std::type_index(typeid(std::filesystem::path)),
-    };
-    return s.contains(type);
-}
-inline bool isIntListType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(std::vector<uint8_t>)),
-        std::type_index(typeid(std::vector<int8_t>)),
-        std::type_index(typeid(std::vector<uint16_t>)),
-        std::type_index(typeid(std::vector<int16_t>)),
-        std::type_index(typeid(std::vector<uint32_t>)),
-        std::type_index(typeid(std::vector<int32_t>)),
-        std::type_index(typeid(std::vector<uint64_t>)),
-        std::type_index(typeid(std::vector<int64_t>)),
-    };
-    return s.contains(type);
+CLICE_INLINE auto cwlValue(ArgumentBase const& arg) -> std::optional<decltype(tdl::Node::value)>;
+CLICE_INLINE auto generateCWL(std::vector<std::string> subtool) -> tdl::ToolInfo;
+
+#if CLICE_DEFINITIONS
+// tdl value matching the type of arg, std::nullopt if it can't be represented
+CLICE_INLINE auto cwlValue(ArgumentBase const& arg) -> std::optional<decltype(tdl::Node::value)> {
+    auto const& type = *arg.type;
+    if (arg.mapping) { //!TODO only works for single values, produces wrong outputs for lists
+        return tdl::StringValue{};
+    }
+    if (type.kind == TypeKind::List) {
+        if (type.cwlType == "int")    return tdl::IntValueList{};
+        if (type.cwlType == "double") return tdl::DoubleValueList{};
+        if (type.cwlType == "string") return tdl::StringValueList{};
+        return std::nullopt;
+    }
+    if (type.cwlType == "boolean") return tdl::BoolValue{};
+    if (type.cwlType == "int")     return tdl::IntValue{};
+    if (type.cwlType == "double")  return tdl::DoubleValue{};
+    if (type.cwlType == "string")  return tdl::StringValue{};
+    return std::nullopt;
 }
 
-inline bool isFloatListType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(std::vector<float>)),
-        std::type_index(typeid(std::vector<double>)),
-    };
-    return s.contains(type);
-}
-inline bool isStringListType(std::type_index type) {
-    static auto s = std::unordered_set<std::type_index> {
-        std::type_index(typeid(std::vector<std::string>)),
-        std::type_index(typeid(std::vector<std::filesystem::path>)),
-    };
-    return s.contains(type);
-}
-
-
-
-inline auto generateCWL(std::vector<std::string> subtool) -> tdl::ToolInfo {
+CLICE_INLINE auto generateCWL(std::vector<std::string> subtool) -> tdl::ToolInfo {
     auto info = tdl::ToolInfo{};
 
-    auto f = std::function<tdl::Node::Children(std::vector<clice::ArgumentBase*>)>{};
+    auto f = std::function<tdl::Node::Children(clice::ArgumentList const&)>{};
 
     f = [&](auto const& args) {
         auto res = tdl::Node::Children{};
         for (auto arg : args) {
+            arg->expandChildren();
             if (subtool.size() > 0) {
                 for (auto a : arg->args) {
                     if (subtool[0] == a) {
@@ -124,23 +83,8 @@ inline auto generateCWL(std::vector<std::string> subtool) -> tdl::ToolInfo {
             //!TODO a few more tags probably need to be converted here
             if (arg->children.size()) {
                 node.value = f(arg->children);
-            } else if (arg->mapping) { //!TODO only works for single values, produces wrong outputs for lists
-                node.value = tdl::StringValue{};
-            } else if (isBoolType(arg->type_index)) {
-                node.value = tdl::BoolValue{};
-            } else if (isIntType(arg->type_index)) {
-                node.value = tdl::IntValue{};
-            } else if (isFloatType(arg->type_index)) {
-                node.value = tdl::DoubleValue{};
-            } else if (isStringType(arg->type_index)) {
-                node.value = tdl::StringValue{};
-            } else if (isIntListType(arg->type_index)) {
-                node.value = tdl::IntValueList{};
-            } else if (isFloatListType(arg->type_index)) {
-                node.value = tdl::DoubleValueList{};
-            } else if (isStringListType(arg->type_index)) {
-                node.value = tdl::StringValueList{};
-
+            } else if (auto value = cwlValue(*arg)) {
+                node.value = *value;
             } else {
                 std::cerr << "unknown on how to convert " + arg->id + " from clice to tdl\n";
                 continue;
@@ -158,5 +102,6 @@ inline auto generateCWL(std::vector<std::string> subtool) -> tdl::ToolInfo {
 
     return info;
 }
+#endif
 }
 #endif
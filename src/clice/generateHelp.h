@@ -7,10 +7,48 @@
 #include <cassert>
 #include <fmt/format.h>
 #include <fmt/ranges.h>
+#include <iterator>
 
 namespace clice {
 
-inline auto typeToString(ArgumentBase const& arg) -> std::string {
+/**
+ * Help rendering
+ *
+ * Everything is written in a single pass into a fmt::memory_buffer.
+ * The generate* functions are convenience wrappers returning a std::string.
+ */
+template <typename... Args>
+void formatTo(fmt::memory_buffer& out, fmt::format_string<Args...> fmt, Args&&... args) {
+    fmt::format_to(std::back_inserter(out), fmt, std::forward<Args>(args)...);
+}
+
+// a single line in the 'Options:' section
+struct HelpRow {
+    std::string         left;    // indented arguments and type, e.g. "  --opt1 STRING"
+    size_t              width;   // width this row requires for the alignment of the descriptions
+    ArgumentBase const* arg;
+    bool                withEnv; // environment variables are listed below the row
+};
+
+CLICE_INLINE auto typeToString(ArgumentBase const& arg) -> std::string;
+CLICE_INLINE void writePartialSynopsis(fmt::memory_buffer& out, ArgumentBase const& arg, bool brackets = true);
+CLICE_INLINE void writeSynopsis(fmt::memory_buffer& out);
+CLICE_INLINE void writeSplitSynopsis(fmt::memory_buffer& out);
+CLICE_INLINE auto generatePartialSynopsis(ArgumentBase const& arg) -> std::string;
+CLICE_INLINE auto generateSynopsis() -> std::string;
+CLICE_INLINE auto generateSplitSynopsis() -> std::string;
+CLICE_INLINE auto helpTagString(ArgumentBase const& arg) -> std::string;
+CLICE_INLINE void collectHelpRows(std::vector<HelpRow>& rows, ArgumentList const& args, size_t ind, size_t measureInd);
+CLICE_INLINE void collectEnvArguments(std::vector<ArgumentBase const*>& bases, ArgumentList const& args);
+CLICE_INLINE void writeHelpSections(fmt::memory_buffer& out, ArgumentList const& args, std::vector<ArgumentBase const*> const& envBases);
+CLICE_INLINE void renderHelp(fmt::memory_buffer& out);
+CLICE_INLINE void renderHelp(fmt::memory_buffer& out, ArgumentBase const& command);
+CLICE_INLINE auto selectedCommand() -> ArgumentBase const*;
+CLICE_INLINE auto generateHelp() -> std::string;
+CLICE_INLINE auto generateHelp(ArgumentBase const& command) -> std::string;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE auto typeToString(ArgumentBase const& arg) -> std::string {
     for (auto t : arg.tags) {
         if (t.starts_with("short: ")) {
             if (arg.tags.contains("multi")) {
@@ -19,270 +57,251 @@ inline auto typeToString(ArgumentBase const& arg) -> std::string {
             return t.substr(7);
         }
     }
-    if (arg.type_index == std::type_index(typeid(std::nullptr_t))) {
+    if (arg.type->kind == TypeKind::Flag) {
         //!Nothing to do, this is a flag and doesn't take any parameters
         return "";
     } else if (arg.mapping) {
         return fmt::format("[{}]", fmt::join(*arg.mapping, "|"));
-    } else if (arg.type_index == std::type_index(typeid(char))) {
-        return "CHAR";
-    } else if (arg.type_index == std::type_index(typeid(bool))) {
-        return "[true|false]";
-    } else if (arg.type_index == std::type_index(typeid(int8_t))) {
-        return "INT8";
-    } else if (arg.type_index == std::type_index(typeid(uint8_t))) {
-        return "UINT8";
-    } else if (arg.type_index == std::type_index(typeid(int16_t))) {
-        return "INT16";
-    } else if (arg.type_index == std::type_index(typeid(uint16_t))) {
-        return "UINT16";
-    } else if (arg.type_index == std::type_index(typeid(int32_t))) {
-        return "INT32";
-    } else if (arg.type_index == std::type_index(typeid(uint32_t))) {
-        return "UINT32";
-    } else if (arg.type_index == std::type_index(typeid(int64_t))) {
-        return "INT64";
-    } else if (arg.type_index == std::type_index(typeid(uint64_t))) {
-        return "UINT64";
-    } else if (arg.type_index == std::type_index(typeid(float))) {
-        return "FLOAT";
-    } else if (arg.type_index == std::type_index(typeid(double))) {
-        return "DOUBLE";
-    } else if (arg.type_index == std::type_index(typeid(std::string))) {
-        return "STRING";
-    } else if (arg.type_index == std::type_index(typeid(std::filesystem::path))) {
-        return "PATH";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<bool>))) {
-        return "[true|false]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<int8_t>))) {
-        return "[INT8]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<uint8_t>))) {
-        return "[UINT8]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<int16_t>))) {
-        return "[INT16]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<uint16_t>))) {
-        return "[UINT16]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<int32_t>))) {
-        return "[INT32]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<uint32_t>))) {
-        return "[UINT32]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<int64_t>))) {
-        return "[INT64]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<uint64_t>))) {
-        return "[UINT64]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<float>))) {
-        return "[FLOAT]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<double>))) {
-        return "[DOUBLE]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<std::string>))) {
-        return "[STRING]...";
-    } else if (arg.type_index == std::type_index(typeid(std::vector<std::filesystem::path>))) {
-        return "[PATH]...";
+    } else if (arg.type->name.empty()) {
+        return "_unknown_";
+    } else if (arg.type->kind == TypeKind::List) {
+        if (arg.type->name.starts_with('[')) {
+            return fmt::format("{}...", arg.type->name);
+        }
+        return fmt::format("[{}]...", arg.type->name);
     }
-    return "_unknown_";
+    return std::string{arg.type->name};
 }
 
-inline auto generatePartialSynopsis(ArgumentBase const& arg) -> std::string {
-    auto ret = fmt::format("{}", fmt::join(arg.args, "|"));
-
-
+// brackets: surround optional arguments with [...]
+CLICE_INLINE void writePartialSynopsis(fmt::memory_buffer& out, ArgumentBase const& arg, bool brackets) {
+    bool optional = brackets && !arg.tags.contains("required");
+    if (optional) out.push_back('[');
+    auto start = out.size();
+    auto separate = [&]() {
+        if (out.size() > start) out.push_back(' ');
+    };
+    formatTo(out, "{}", fmt::join(arg.args, "|"));
+    arg.expandChildren();
     for (auto child : arg.children) {
-        ret += " " + generatePartialSynopsis(*child);
+        separate();
+        writePartialSynopsis(out, *child);
     }
     if (arg.id.empty()) {
         auto typeAsString = typeToString(arg);
-        ret += typeAsString.empty()?"":(" " + typeAsString);
+        if (!typeAsString.empty()) {
+            separate();
+            formatTo(out, "{}", typeAsString);
+        }
     } else {
-        ret += " " + arg.id;
-    }
-
-    // remove spaaces at the beginning
-    while (!ret.empty() && ret.front() == ' ') {
-        ret.erase(ret.begin());
-    }
-    // suround parameter with [...] if it is an optional type
-    if (!arg.tags.contains("required")) {
-        ret = "[" + ret + "]";
+        separate();
+        formatTo(out, "{}", arg.id);
     }
-    return  ret;
+    if (optional) out.push_back(']');
 }
-inline auto generateSynopsis() -> std::string {
-    auto ret = argv0;
+
+CLICE_INLINE void writeSynopsis(fmt::memory_buffer& out) {
+    formatTo(out, "{}", argv0);
     for (auto const& arg : Register::getInstance().arguments) {
-        ret += " " + generatePartialSynopsis(*arg);
+        out.push_back(' ');
+        writePartialSynopsis(out, *arg);
     }
-    return ret;
 }
 
-inline auto generateSplitSynopsis() -> std::string {
-    auto ret = std::string{};
+CLICE_INLINE void writeSplitSynopsis(fmt::memory_buffer& out) {
     auto bases = std::vector<ArgumentBase const*>{};
+    auto start = out.size();
+    formatTo(out, "{} ", argv0);
+    auto prefixEnd = out.size();
     for (auto const& arg : Register::getInstance().arguments) {
         if (!arg->args.empty() and arg->args[0][0] != '-') {
             bases.emplace_back(arg);
         } else {
-            ret += " " + generatePartialSynopsis(*arg);
+            out.push_back(' ');
+            writePartialSynopsis(out, *arg);
         }
     }
-    if (ret.size() > 0) {
-        ret = fmt::format("{} {}\n", argv0, ret);
+    if (out.size() == prefixEnd) {
+        out.resize(start);
+    } else {
+        out.push_back('\n');
     }
     for (auto arg : bases) {
-        auto s = generatePartialSynopsis(*arg);
-        assert(s.size() >= 2);
-        s.pop_back();
-        s.erase(s.begin());
-        ret = fmt::format("{}{} {}\n", ret, argv0, s);
+        formatTo(out, "{} ", argv0);
+        writePartialSynopsis(out, *arg, /*.brackets=*/false);
+        out.push_back('\n');
     }
-    return ret;
 }
 
-inline auto generateHelp() -> std::string {
-    auto ret = std::string{};
-
-    ret = fmt::format("Usage:\n");
-    ret += generateSynopsis() + "\n\n";
-    ret += fmt::format("Subcommand usage:\n");
-    ret = ret + generateSplitSynopsis();
-
-    auto& args = clice::Register::getInstance().arguments;
-
-    auto f = std::function<void(std::vector<clice::ArgumentBase*>, std::string)>{};
+CLICE_INLINE auto generatePartialSynopsis(ArgumentBase const& arg) -> std::string {
+    auto out = fmt::memory_buffer{};
+    writePartialSynopsis(out, arg);
+    return fmt::to_string(out);
+}
 
-    // Find longest word (for correct indentation)
-    size_t longestWord{};
-    f = [&](auto const& args, std::string ind) {
-        for (auto arg : args) {
-            auto typeAsString = typeToString(*arg);
-            if (!arg->id.empty()) {
-                typeAsString = arg->id;
-            }
+CLICE_INLINE auto generateSynopsis() -> std::string {
+    auto out = fmt::memory_buffer{};
+    writeSynopsis(out);
+    return fmt::to_string(out);
+}
 
-            auto argstr = fmt::format("{}{} {}", ind, fmt::join(arg->args, ", "), typeAsString);
-            longestWord = std::max(longestWord, argstr.size());
-        }
+CLICE_INLINE auto generateSplitSynopsis() -> std::string {
+    auto out = fmt::memory_buffer{};
+    writeSplitSynopsis(out);
+    return fmt::to_string(out);
+}
 
-        for (auto arg : args) {
-            if (!arg->args.empty()) continue;
-            f(arg->children, ind + "  ");
-        }
+// "(required)", "(default: ...)" or ""
+CLICE_INLINE auto helpTagString(ArgumentBase const& arg) -> std::string {
+    if (arg.tags.contains("required")) return "(required)";
+    auto defaultValue = arg.toString();
+    if (!defaultValue) return "";
+    return fmt::format("(default: {})", *defaultValue);
+}
 
-        for (auto arg : args) {
-            if (arg->args.empty() or arg->args[0][0] == '-') continue;
-            f(arg->children, ind + "  ");
-        }
-        for (auto arg : args) {
-            if (arg->args.empty() or arg->args[0][0] != '-') continue;
-            f(arg->children, ind + "  ");
-        }
+/**
+ * Collects the rows in printing order: positional arguments, commands and options.
+ * Positional children are printed on the same indentation level, but measured one level deeper.
+ */
+CLICE_INLINE void collectHelpRows(std::vector<HelpRow>& rows, ArgumentList const& args, size_t ind, size_t measureInd) {
+    auto typeAsString = [](ArgumentBase const& arg) {
+        return arg.id.empty()?typeToString(arg):arg.id;
+    };
+    auto argString = [&](ArgumentBase const& arg) {
+        return fmt::format("{:{}}{} {}", "", ind, fmt::join(arg.args, ", "), typeAsString(arg));
     };
-    f(args, "");
 
-    if (longestWord > 0) {
-        ret += "\n\nOptions:\n";
+    for (auto arg : args) {
+        if (!arg->args.empty()) continue;
+        auto type = typeAsString(*arg);
+        auto width = measureInd + 1 + type.size();
+        rows.push_back({std::move(type), width, arg, false});
+        arg->expandChildren();
+        collectHelpRows(rows, arg->children, ind, measureInd + 2);
     }
+    for (auto arg : args) {
+        if (arg->args.empty() or arg->args[0][0] == '-') continue;
+        auto str = argString(*arg);
+        auto width = str.size() - ind + measureInd;
+        rows.push_back({std::move(str), width, arg, false});
+        arg->expandChildren();
+        collectHelpRows(rows, arg->children, ind + 2, measureInd + 2);
+    }
+    for (auto arg : args) {
+        if (arg->args.empty() or arg->args[0][0] != '-') continue;
+        auto str = argString(*arg);
+        auto width = str.size() - ind + measureInd;
+        rows.push_back({std::move(str), width, arg, true});
+        arg->expandChildren();
+        collectHelpRows(rows, arg->children, ind + 2, measureInd + 2);
+    }
+}
 
-    f = [&](auto const& args, std::string ind) {
+CLICE_INLINE void collectEnvArguments(std::vector<ArgumentBase const*>& bases, ArgumentList const& args) {
+    for (auto arg : args) {
+        if (arg->env.size()) {
+            bases.push_back(arg);
+        }
+        arg->expandChildren();
+        collectEnvArguments(bases, arg->children);
+    }
+}
 
-        for (auto arg : args) {
-            if (!arg->args.empty()) continue;
-            auto typeAsString = typeToString(*arg);
-            if (!arg->id.empty()) {
-                typeAsString = arg->id;
-            }
+// writes the 'Options:' and 'Environment Variables:' sections
+CLICE_INLINE void writeHelpSections(fmt::memory_buffer& out, ArgumentList const& args, std::vector<ArgumentBase const*> const& envBases) {
+    auto rows = std::vector<HelpRow>{};
+    collectHelpRows(rows, args, 0, 0);
 
-            auto tagstr = [&]() -> std::string {
-                if (arg->tags.contains("required")) return "(required)";
-                auto defaultValue = arg->toString();
-                if (!defaultValue) return "";
-                return fmt::format("(default: {})", *defaultValue);
-            }();
+    size_t longestWord{};
+    for (auto const& row : rows) {
+        longestWord = std::max(longestWord, row.width);
+    }
 
-            ret = ret + fmt::format("{:<{}} - {} {}\n", typeAsString, longestWord, arg->desc, tagstr);
-            f(arg->children, ind);
+    if (longestWord > 0) {
+        formatTo(out, "\n\nOptions:\n");
+    }
+    for (auto const& row : rows) {
+        formatTo(out, "{:<{}} - {} {}\n", row.left, longestWord, row.arg->desc, helpTagString(*row.arg));
+        if (row.withEnv and !row.arg->env.empty()) {
+            formatTo(out, "{:<{}}   environment variable {}\n", "", longestWord, fmt::join(row.arg->env, ", "));
         }
+    }
 
-        for (auto arg : args) {
-            if (arg->args.empty() or arg->args[0][0] == '-') continue;
-            auto typeAsString = typeToString(*arg);
-            if (!arg->id.empty()) {
-                typeAsString = arg->id;
+    if (envBases.size()) {
+        formatTo(out, "\n\nEnvironment Variables:\n");
+        for (auto arg : envBases) {
+            auto env_str = fmt::format("{}", fmt::join(arg->env, ", "));
+            if (arg->args.empty()) {
+                formatTo(out, "{:<{}} - {} {}\n", env_str, longestWord, arg->desc, helpTagString(*arg));
+            } else {
+                formatTo(out, "{:<{}} - same as {}\n", env_str, longestWord, fmt::join(arg->args, ", "));
             }
-            auto argstr = fmt::format("{}{} {}", ind, fmt::join(arg->args, ", "), typeAsString);
-            auto tagstr = [&]() -> std::string {
-                if (arg->tags.contains("required")) return "(required)";
-                auto defaultValue = arg->toString();
-                if (!defaultValue) return "";
-                return fmt::format("(default: {})", *defaultValue);
-            }();
-
-            ret = ret + fmt::format("{:<{}} - {} {}\n", argstr, longestWord, arg->desc, tagstr);
-            f(arg->children, ind + "  ");
         }
-        for (auto arg : args) {
-            if (arg->args.empty() or arg->args[0][0] != '-') continue;
-            auto typeAsString = typeToString(*arg);
-            if (!arg->id.empty()) {
-                typeAsString = arg->id;
-            }
-
-            auto argstr = fmt::format("{}{} {}", ind, fmt::join(arg->args, ", "), typeAsString);
-            auto tagstr = [&]() -> std::string {
-                if (arg->tags.contains("required")) return "(required)";
-                auto defaultValue = arg->toString();
-                if (!defaultValue) return "";
-                return fmt::format("(default: {})", *defaultValue);
-            }();
-            ret = ret + fmt::format("{:<{}} - {} {}\n", argstr, longestWord, arg->desc, tagstr);
-            if (!arg->env.empty()) {
-                ret = ret + fmt::format("{:<{}}   environment variable {}\n", "", longestWord, fmt::join(arg->env, ", "));
-            }
+    }
+}
 
-            f(arg->children, ind + "  ");
-        }
-    };
-    f(args, "");
+CLICE_INLINE void renderHelp(fmt::memory_buffer& out) {
+    formatTo(out, "Usage:\n");
+    writeSynopsis(out);
+    formatTo(out, "\n\nSubcommand usage:\n");
+    writeSplitSynopsis(out);
 
-    // print environment variables
-    {
-        // collect all argument bases with environment variables
-        auto bases = std::vector<ArgumentBase*>{};
-        auto visitAllArguments = std::function<void(std::vector<ArgumentBase*> const&)>{};
-        visitAllArguments = [&](auto const& args) {
-            for (auto arg : args) {
-                if (arg->env.size()) {
-                    bases.push_back(arg);
-                }
-                for (auto child : arg->children) {
-                    visitAllArguments(child->children);
-                }
-            }
-        };
-        visitAllArguments(Register::getInstance().arguments);
+    auto const& args = Register::getInstance().arguments;
+    auto envBases = std::vector<ArgumentBase const*>{};
+    collectEnvArguments(envBases, args);
+    writeHelpSections(out, args, envBases);
+}
 
-        if (bases.size()) {
-            ret += "\n\nEnvironment Variables:\n";
+// help page of a single (sub)command and its child arguments
+CLICE_INLINE void renderHelp(fmt::memory_buffer& out, ArgumentBase const& command) {
+    auto path = std::vector<std::string_view>{};
+    for (auto a = command.parent; a; a = a->parent) {
+        path.insert(path.begin(), a->args.empty()?std::string_view{a->id}:std::string_view{a->args[0]});
+    }
+    formatTo(out, "Usage:\n{} ", argv0);
+    for (auto p : path) {
+        formatTo(out, "{} ", p);
+    }
+    writePartialSynopsis(out, command, /*.brackets=*/false);
+    out.push_back('\n');
 
-            for (auto arg : bases) {
-                std::string env;
-                auto env_str = fmt::format("{}", fmt::join(arg->env, ", "));
-                if (arg->args.empty()) {
-                    auto tagstr = [&]() -> std::string {
-                        if (arg->tags.contains("required")) return "(required)";
-                        auto defaultValue = arg->toString();
-                        if (!defaultValue) return "";
-                        return fmt::format("(default: {})", *defaultValue);
-                    }();
+    command.expandChildren();
+    auto envBases = std::vector<ArgumentBase const*>{};
+    if (command.env.size()) {
+        envBases.push_back(&command);
+    }
+    collectEnvArguments(envBases, command.children);
+    writeHelpSections(out, command.children, envBases);
+}
 
-                    ret = ret + fmt::format("{:<{}} - {} {}\n", env_str, longestWord, arg->desc, tagstr);
-                } else {
-                    auto arg_str = fmt::format("{}", fmt::join(arg->args, ", "));
-                    ret = ret + fmt::format("{:<{}} - same as {}\n", env_str, longestWord, arg_str);
-                }
+// the deepest command (argument without dashes and with children) given on the command line
+CLICE_INLINE auto selectedCommand() -> ArgumentBase const* {
+    ArgumentBase const* selected{};
+    auto const* args = &Register::getInstance().arguments;
+    for (bool found{true}; found;) {
+        found = false;
+        for (auto arg : *args) {
+            if (arg->isSet and !arg->children.empty() and !arg->args.empty() and arg->args[0][0] != '-') {
+                selected = arg;
+                args     = &arg->children;
+                found    = true;
+                break;
             }
         }
     }
+    return selected;
+}
+
+CLICE_INLINE auto generateHelp() -> std::string {
+    auto out = fmt::memory_buffer{};
+    renderHelp(out);
+    return fmt::to_string(out);
+}
 
-    return ret;
+CLICE_INLINE auto generateHelp(ArgumentBase const& command) -> std::string {
+    auto out = fmt::memory_buffer{};
+    renderHelp(out, command);
+    return fmt::to_string(out);
 }
+#endif
 }
@@ -0,0 +1,192 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "embeddedHelp.h"
+#include "generateCWL.h"
+#include "generateHelp.h"
+
+#include <algorithm>
+#include <fmt/format.h>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clice {
+
+/**
+ * Schema of the whole argument tree
+ *
+ * Written in a single pass as compact JSON, so wrapper generators and workflow engines can read
+ * the schema instead of running the program once per subcommand:
+ *
+ *   {"clice-schema":1,"program":"...","arguments":[<argument>...],"cwl":{"<command path>":"..."}}
+ *
+ * <argument> has the fields args, id, desc, env, tags, symlink, kind ("flag", "value" or "list"),
+ * element, type (as shown on the help page), cwlType, default (toString, null if none), mapping
+ * (null if none), completion ("none", "files" or "dynamic") and children.
+ * "cwl" contains a CWL description of the program ("") and of every subcommand, it is only
+ * present if clice was built with CLICE_USE_TDL.
+ */
+
+CLICE_INLINE void writeJsonString(fmt::memory_buffer& out, std::string_view str);
+CLICE_INLINE auto schemaKindName(TypeKind kind) -> std::string_view;
+CLICE_INLINE auto schemaElementName(ElementKind element) -> std::string_view;
+CLICE_INLINE void writeSchemaArgument(fmt::memory_buffer& out, ArgumentBase const& arg);
+CLICE_INLINE void writeSchema(fmt::memory_buffer& out);
+CLICE_INLINE auto generateSchema() -> std::string;
+
+template <typename Range>
+void writeJsonStringList(fmt::memory_buffer& out, Range const& range) {
+    out.push_back('[');
+    bool first{true};
+    for (auto const& s : range) {
+        if (!first) out.push_back(',');
+        first = false;
+        writeJsonString(out, s);
+    }
+    out.push_back(']');
+}
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE void writeJsonString(fmt::memory_buffer& out, std::string_view str) {
+    out.push_back('"');
+    for (auto c : str) {
+        switch (c) {
+        case '"':  out.append(std::string_view{"\\\""}); break;
+        case '\\': out.append(std::string_view{"\\\\"}); break;
+        case '\n': out.append(std::string_view{"\\n"}); break;
+        case '\t': out.append(std::string_view{"\\t"}); break;
+        case '\r': out.append(std::string_view{"\\r"}); break;
+        default:
+            if (static_cast<unsigned char>(c) < 0x20) {
+                formatTo(out, "\\u{:04x}", static_cast<unsigned char>(c));
+            } else {
+                out.push_back(c);
+            }
+        }
+    }
+    out.push_back('"');
+}
+
+CLICE_INLINE auto schemaKindName(TypeKind kind) -> std::string_view {
+    switch (kind) {
+    case TypeKind::Flag:  return "flag";
+    case TypeKind::Value: return "value";
+    case TypeKind::List:  return "list";
+    }
+    return "";
+}
+
+CLICE_INLINE auto schemaElementName(ElementKind element) -> std::string_view {
+    switch (element) {
+    case ElementKind::None:    return "none";
+    case ElementKind::Bool:    return "bool";
+    case ElementKind::Char:    return "char";
+    case ElementKind::Int:     return "int";
+    case ElementKind::Float:   return "float";
+    case ElementKind::String:  return "string";
+    case ElementKind::Path:    return "path";
+    case ElementKind::Enum:    return "enum";
+    case ElementKind::Unknown: return "unknown";
+    }
+    return "";
+}
+
+CLICE_INLINE void writeSchemaArgument(fmt::memory_buffer& out, ArgumentBase const& arg) {
+    auto tags = std::vector<std::string_view>{arg.tags.begin(), arg.tags.end()};
+    std::ranges::sort(tags);
+
+    out.append(std::string_view{"{\"args\":"});
+    writeJsonStringList(out, arg.args);
+    out.append(std::string_view{",\"id\":"});
+    writeJsonString(out, arg.id);
+    out.append(std::string_view{",\"desc\":"});
+    writeJsonString(out, arg.desc);
+    out.append(std::string_view{",\"env\":"});
+    writeJsonStringList(out, arg.env);
+    out.append(std::string_view{",\"tags\":"});
+    writeJsonStringList(out, tags);
+    formatTo(out, ",\"symlink\":{},\"kind\":\"{}\",\"element\":\"{}\",\"type\":", arg.symlink, schemaKindName(arg.type->kind), schemaElementName(arg.type->element));
+    writeJsonString(out, typeToString(arg));
+    out.append(std::string_view{",\"cwlType\":"});
+    writeJsonString(out, arg.type->cwlType);
+    out.append(std::string_view{",\"default\":"});
+    if (auto value = arg.toString?arg.toString():std::nullopt; value) {
+        writeJsonString(out, *value);
+    } else {
+        out.append(std::string_view{"null"});
+    }
+    out.append(std::string_view{",\"mapping\":"});
+    if (arg.mapping) {
+        writeJsonStringList(out, *arg.mapping);
+    } else {
+        out.append(std::string_view{"null"});
+    }
+    auto completion = arg.completion_fn?"dynamic":(arg.type->completion == CompletionHint::Files)?"files":"none";
+    formatTo(out, ",\"completion\":\"{}\",\"children\":[", completion);
+    arg.expandChildren();
+    bool first{true};
+    for (auto child : arg.children) {
+        if (!first) out.push_back(',');
+        first = false;
+        writeSchemaArgument(out, *child);
+    }
+    out.append(std::string_view{"]}"});
+}
+
+#ifdef CLICE_USE_TDL
+// CWL description of the program and of every subcommand
+CLICE_INLINE void writeSchemaCWL(fmt::memory_buffer& out) {
+    auto write = [&](std::vector<std::string> const& subtool, std::string_view key) {
+        auto info = generateCWL(subtool);
+        info.metaInfo.name           = argv0;
+        info.metaInfo.executableName = argv0;
+        writeJsonString(out, key);
+        out.push_back(':');
+        writeJsonString(out, convertToCWL(info));
+    };
+    out.append(std::string_view{",\"cwl\":{"});
+    write({}, "");
+    auto path = std::vector<std::string>{};
+    auto f = [&](auto const& self, ArgumentList const& args) -> void {
+        for (auto arg : args) {
+            arg->expandChildren();
+            if (arg->children.empty() or arg->args.empty() or arg->args[0][0] == '-') continue;
+            path.push_back(arg->args[0]);
+            out.push_back(',');
+            write(path, commandPath(*arg));
+            self(self, arg->children);
+            path.pop_back();
+        }
+    };
+    f(f, Register::getInstance().arguments);
+    out.push_back('}');
+}
+#endif
+
+CLICE_INLINE void writeSchema(fmt::memory_buffer& out) {
+    out.append(std::string_view{"{\"clice-schema\":1,\"program\":"});
+    writeJsonString(out, argv0);
+    out.append(std::string_view{",\"arguments\":["});
+    bool first{true};
+    for (auto arg : Register::getInstance().arguments) {
+        if (!first) out.push_back(',');
+        first = false;
+        writeSchemaArgument(out, *arg);
+    }
+    out.push_back(']');
+#ifdef CLICE_USE_TDL
+    writeSchemaCWL(out);
+#endif
+    out.append(std::string_view{"}\n"});
+}
+
+CLICE_INLINE auto generateSchema() -> std::string {
+    auto out = fmt::memory_buffer{};
+    writeSchema(out);
+    return fmt::to_string(out);
+}
+#endif
+
+}
@@ -0,0 +1,60 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+
+#include <chrono>
+#include <functional>
+#include <tuple>
+#include <vector>
+
+/**
+ * USDT probes (provider "clice") at the phase boundaries of clice::parse
+ *
+ * Compiled in with CLICE_USDT (CMake: -DCLICE_USDT=ON), requires <sys/sdt.h> (e.g. systemtap-sdt-dev).
+ * A probe is a single nop until a tracer attaches, e.g.:
+ *   bpftrace -e 'usdt:./tool:clice:callback__begin { printf("%s\n", str(arg1)); }'
+ *
+ *   parse__begin(argc)               env__end(conversions)
+ *   tokens__end(tokens, conversions) callback__begin(ArgumentBase*, name)
+ *   callback__end(ArgumentBase*, name) parse__end(callbacks)
+ */
+#ifdef CLICE_USDT
+    #if !__has_include(<sys/sdt.h>)
+        #error "CLICE_USDT requires <sys/sdt.h>"
+    #endif
+    #include <sys/sdt.h>
+    #define CLICE_PROBE1(name, a)    DTRACE_PROBE1(clice, name, a)
+    #define CLICE_PROBE2(name, a, b) DTRACE_PROBE2(clice, name, a, b)
+#else
+    #define CLICE_PROBE1(name, a)
+    #define CLICE_PROBE2(name, a, b)
+#endif
+
+namespace clice {
+
+/**
+ * Durations and counters of a single clice::parse call
+ *
+ * Timings are only taken if parseReportSink is set or profiling is enabled (see profile.h).
+ */
+struct ParseReport {
+    std::chrono::nanoseconds environmentTime{}; // reading environment variables (including their conversions)
+    std::chrono::nanoseconds tokensTime{};      // walking argv (including value conversions)
+    std::chrono::nanoseconds validationTime{};  // checking required arguments
+    std::chrono::nanoseconds callbacksTime{};   // all .cb
+    std::chrono::nanoseconds totalTime{};
+
+    size_t tokens{};      // elements of argv that were processed
+    size_t conversions{}; // calls to fromString (argv and environment)
+    size_t callbacks{};   // calls of .cb
+
+    // wall and CPU time of every .cb call, in call order
+    std::vector<std::tuple<ArgumentBase const*, std::chrono::nanoseconds, std::chrono::nanoseconds>> callbackTimes;
+};
+
+// called at the end of every successful clice::parse, if set
+inline std::function<void(ParseReport const&)> parseReportSink{};
+
+}
@@ -0,0 +1,73 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace clice {
+
+/**
+ * Result of an invocable .value, evaluated at most once
+ *
+ * get() costs a single acquire load once the value exists. The first get() evaluates the
+ * invocable under std::call_once, concurrent callers wait for it (also for an evaluation started
+ * by .prefetch, see prefetch.h). set() stores a value given on the command line (or restored
+ * from a snapshot); it is called while parsing, before other threads read the argument.
+ */
+template <typename R>
+struct LazyValue {
+    template <typename F>
+    auto get(F const& f) const -> R const& {
+        if (!ready.load(std::memory_order_acquire)) {
+            evaluate(f);
+        }
+        return *value;
+    }
+
+    // evaluates f, unless that already happened or a value was set
+    template <typename F>
+    void evaluate(F const& f) const {
+        std::call_once(once, [&]() {
+            value.emplace(f());
+            ready.store(true, std::memory_order_release);
+        });
+    }
+
+    void set(R v) {
+        std::call_once(once, []() {}); // waits for a running evaluation, prevents later ones
+        value = std::move(v);
+        ready.store(true, std::memory_order_release);
+    }
+
+    // nullptr if neither evaluated nor set
+    auto tryGet() const -> R const* {
+        return ready.load(std::memory_order_acquire)?&*value:nullptr;
+    }
+
+private:
+    mutable std::atomic<bool>     ready{};
+    mutable std::once_flag        once;
+    mutable std::optional<R>      value;
+};
+
+// storage of Argument<T> for non invocable values
+struct NoLazyValue {};
+
+template <typename T, bool = std::is_invocable_v<T>>
+struct LazyStorageOf {
+    using type = NoLazyValue;
+};
+
+template <typename T>
+struct LazyStorageOf<T, true> {
+    using type = LazyValue<std::decay_t<std::invoke_result_t<T>>>;
+};
+
+template <typename T>
+using LazyStorage = typename LazyStorageOf<T>::type;
+
+}
@@ -3,64 +3,271 @@
 #pragma once
 
 #include "Argument.h"
+#include "completionCache.h"
+#include "configFile.h"
+#include "embeddedHelp.h"
 #include "generateHelp.h"
+#include "generateSchema.h"
+#include "instrumentation.h"
+#include "prefetch.h"
 #include "printCompletion.h"
+#include "profile.h"
+#include "snapshot.h"
+#include "triggers.h"
 
+#include <array>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
 #include <cstdlib>
 #include <fmt/format.h>
 #include <iostream>
 #include <list>
-#include <map>
+#include <memory_resource>
 #include <set>
 #include <span>
 
 namespace clice {
 
-namespace {
-inline void makeCompletionSuggestion(std::vector<ArgumentBase*> const& activeBases, std::string_view arg) {
-    // single completion
-    if (activeBases.size() and activeBases.back()->fromString and activeBases.back()->completion and (arg.empty() || arg[0] != '-')) {
-        fmt::print("{}", *activeBases.back()->completion);
-        return;
+struct Parse {
+    std::tuple<int, char const* const*> args;
+    std::string desc;            // description of the tool
+    bool allowDashCombi{false};  // allows to combine "-a -b" into "-ab"
+    bool helpOpt{false};         // automatically registers --help option
+    bool catchExceptions{false}; // catches exception and prints them
+    std::function<void()> run{}; // function to run
+    ProfileFormat profile{ProfileFormat::None}; // times callbacks and run, prints a report at exit (see profile.h)
+    std::vector<std::filesystem::path> config{}; // config files, missing files are skipped (see configFile.h)
+};
+
+CLICE_INLINE auto fuzzyCompletionScore(std::string_view candidate, std::string_view pattern) -> size_t;
+CLICE_INLINE void printCompletionMatches(std::vector<std::string_view> candidates, std::string_view word);
+CLICE_INLINE void makeCompletionSuggestion(std::vector<ArgumentBase*> const& activeBases, bool awaitsValue, std::string_view arg);
+CLICE_INLINE void completeArguments(std::span<std::string_view> args);
+CLICE_INLINE auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<std::string>;
+CLICE_INLINE auto parseSingleDash(int _argc, char const* const* _argv) -> std::optional<std::string>;
+CLICE_INLINE auto parse(std::span<std::string_view> args, bool allowDashCombi = false) -> std::optional<std::string>;
+CLICE_INLINE auto parse(int argc, char const* const* argv, bool allowDashCombi = false) -> std::optional<std::string>;
+CLICE_INLINE void parse(Parse const& parse);
+
+#if CLICE_DEFINITIONS
+/**
+ * Fuzzy score of candidate for the typed pattern, 0 if it doesn't match.
+ * All chars of pattern must appear in order in candidate, consecutive chars,
+ * chars at word boundaries and prefix matches rank higher.
+ */
+CLICE_INLINE auto fuzzyCompletionScore(std::string_view candidate, std::string_view pattern) -> size_t {
+    size_t score{1};
+    size_t pos{0};
+    for (size_t i{0}; i < pattern.size(); ++i) {
+        auto idx = candidate.find(pattern[i], pos);
+        if (idx == std::string_view::npos) return 0;
+        if (i > 0 && idx == pos) {
+            score += 3;
+        } else if (idx == 0 || std::string_view{"-_./"}.find(candidate[idx-1]) != std::string_view::npos) {
+            score += 2;
+        } else {
+            score += 1;
+        }
+        pos = idx+1;
+    }
+    if (candidate.starts_with(pattern)) {
+        score += pattern.size() * 4;
+    }
+    return score;
+}
+
+/**
+ * Filters candidates by the word that is being completed
+ * CLICE_COMPLETION_FUZZY: if set, candidates are fuzzy matched and ranked instead of prefix matched
+ * CLICE_COMPLETION_LIMIT: maximum number of printed candidates (default: no limit)
+ */
+CLICE_INLINE void printCompletionMatches(std::vector<std::string_view> candidates, std::string_view word) {
+    auto limit = std::numeric_limits<size_t>::max();
+    if (auto ptr = std::getenv("CLICE_COMPLETION_LIMIT"); ptr && *ptr) {
+        // an invalid limit is ignored, completion must not fail
+        try {
+            limit = parseFromString<size_t>(ptr);
+        } catch (...) {}
     }
-    if (activeBases.size() and activeBases.back()->fromString and activeBases.back()->completion_fn and (arg.empty() || arg[0] != '-')) {
-        for (auto c : activeBases.back()->completion_fn()) {
-            fmt::print("{}\n", c);
+
+    if (std::getenv("CLICE_COMPLETION_FUZZY") != nullptr) {
+        auto ranked = std::vector<std::tuple<size_t, std::string_view>>{};
+        for (auto c : candidates) {
+            if (auto score = fuzzyCompletionScore(c, word); score > 0) {
+                ranked.emplace_back(score, c);
+            }
+        }
+        std::ranges::sort(ranked, [](auto const& lhs, auto const& rhs) {
+            if (std::get<0>(lhs) != std::get<0>(rhs)) return std::get<0>(lhs) > std::get<0>(rhs);
+            return std::get<1>(lhs) < std::get<1>(rhs);
+        });
+        auto last = std::ranges::unique(ranked, {}, [](auto const& t) { return std::get<1>(t); }).begin();
+        ranked.erase(last, ranked.end());
+        for (size_t i{0}; i < ranked.size() && i < limit; ++i) {
+            fmt::print("{}\n", std::get<1>(ranked[i]));
         }
         return;
     }
 
-    auto options = std::vector<std::tuple<std::string, std::string>>{};
+    // sorted candidates (e.g. mappings) are searched directly, otherwise only the matches are sorted
+    auto first = candidates.begin();
+    auto last  = candidates.end();
+    if (std::ranges::is_sorted(candidates)) {
+        first = std::lower_bound(first, last, word);
+        last  = std::find_if(first, last, [&](auto c) { return !c.starts_with(word); });
+    } else {
+        last = std::remove_if(first, last, [&](auto c) { return !c.starts_with(word); });
+        std::sort(first, last);
+    }
+    last = std::unique(first, last);
+    for (size_t i{0}; first != last && i < limit; ++first, ++i) {
+        fmt::print("{}\n", *first);
+    }
+}
+
+/**
+ * activeBases: arguments whose children are of interest
+ * awaitsValue: the last active base still takes a value
+ */
+CLICE_INLINE void makeCompletionSuggestion(std::vector<ArgumentBase*> const& activeBases, bool awaitsValue, std::string_view arg) {
+    // single completion
+    if (activeBases.size() and awaitsValue and (arg.empty() || arg[0] != '-')) {
+        auto const& base = *activeBases.back();
+        if (base.completion_fn) {
+            auto values     = completionValues(base);
+            auto candidates = std::vector<std::string_view>{values.begin(), values.end()};
+            printCompletionMatches(std::move(candidates), arg);
+            return;
+        }
+        if (base.mapping) {
+            printCompletionMatches({base.mapping->begin(), base.mapping->end()}, arg);
+            return;
+        }
+        if (base.type->completion == CompletionHint::Files) {
+            fmt::print(" -f ");
+            return;
+        }
+    }
+
+    auto options = std::vector<std::string_view>{};
     for (auto bases : activeBases) {
         for (auto arg : bases->children) {
             if (!arg->args.empty()) {
-                options.emplace_back(arg->args[0], arg->desc);
+                options.emplace_back(arg->args[0]);
             }
         }
     }
     for (auto arg : Register::getInstance().arguments) {
         if (!arg->args.empty()) {
-            options.emplace_back(arg->args[0], arg->desc);
+            options.emplace_back(arg->args[0]);
         }
     }
-    size_t longestWord = {};
-    for (auto const& [arg, desc] : options) {
-        longestWord = std::max(longestWord, arg.size());
-    }
     //!TODO maybe we also want to show descriptions?
+    printCompletionMatches(std::move(options), arg);
+}
+
+/**
+ * Completion mode (CLICE_COMPLETION is set)
+ *
+ * Walks the argument tree like parse() does, but never calls init, fromString or callbacks.
+ * Values are not converted, so malformed values or unknown words before the cursor are tolerated.
+ * The last entry of args is the word being completed.
+ */
+CLICE_INLINE void completeArguments(std::span<std::string_view> args) {
+    struct Active {
+        ArgumentBase* arg;
+        bool          awaitsValue; // single value argument that didn't receive its value yet
+    };
+    auto activeBases    = std::vector<Active>{};
+    auto usedPositional = std::vector<ArgumentBase*>{}; // positional arguments that already received their value
+
+    auto takesValue = [](ArgumentBase const* arg) {
+        return arg->type->kind != TypeKind::Flag;
+    };
+    auto isMulti = [](ArgumentBase const* arg) {
+        return arg->tags.contains("multi");
+    };
+    auto findArg = [](ArgumentList const& args, std::string_view str) -> ArgumentBase* {
+        for (auto arg : args) {
+            if (std::ranges::find(arg->args, str) != arg->args.end()) {
+                return arg;
+            }
+        }
+        return nullptr;
+    };
+    auto findPositional = [&](ArgumentList const& args) -> ArgumentBase* {
+        for (auto arg : args) {
+            if (arg->args.empty() && (isMulti(arg) || std::ranges::find(usedPositional, arg) == usedPositional.end())) {
+                return arg;
+            }
+        }
+        return nullptr;
+    };
+    auto activate = [&](ArgumentBase* arg) {
+        arg->expandChildren();
+        activeBases.push_back({arg, takesValue(arg) && !isMulti(arg)});
+    };
+
+    bool allTrailing = false;
+    for (size_t i{1}; i+1 < args.size(); ++i) {
+        if (args[i] == "--" and !allTrailing) {
+            allTrailing = true;
+            continue;
+        }
+
+        [&]() {
+            // walk up the arguments, until one active argument has a child with fitting parameter
+            for (size_t j{0}; j < activeBases.size(); ++j) {
+                auto& base      = activeBases[activeBases.size()-j-1];
+                auto  multi     = isMulti(base.arg);
+                auto  hasValue  = base.awaitsValue || (multi && takesValue(base.arg));
+                if (hasValue and (!args[i].starts_with("-") or allTrailing or !multi) and (!multi || base.arg->args.size()>0 || allTrailing)) {
+                    base.awaitsValue = false;
+                    return;
+                }
+                if (auto arg = findArg(base.arg->children, args[i]); arg) {
+                    activate(arg);
+                    return;
+                }
+                if (!multi && hasValue) {
+                    return; // a value is missing, parse() would fail here
+                }
+            }
+            if (auto arg = findArg(Register::getInstance().arguments, args[i]); arg) {
+                activate(arg);
+                return;
+            }
+            // positional arguments: first walk up active arguments, second check root arguments
+            for (size_t j{0}; j < activeBases.size(); ++j) {
+                if (auto arg = findPositional(activeBases[activeBases.size()-j-1].arg->children); arg) {
+                    arg->expandChildren();
+                    usedPositional.push_back(arg);
+                    activeBases.push_back({arg, false});
+                    return;
+                }
+            }
+            if (auto arg = findPositional(Register::getInstance().arguments); arg) {
+                arg->expandChildren();
+                usedPositional.push_back(arg);
+                activeBases.push_back({arg, false});
+                return;
+            }
+            // otherwise the word is a value of a multi value argument or unknown, both don't change the state
+        }();
+    }
 
-    std::ranges::sort(options);
-    for (auto const& [arg, desc] : options) {
-        fmt::print("{}\n", arg);
+    auto bases = std::vector<ArgumentBase*>{};
+    for (auto const& base : activeBases) {
+        bases.push_back(base.arg);
     }
-}
+    bool awaitsValue = activeBases.size() && (activeBases.back().awaitsValue
+                       || (isMulti(activeBases.back().arg) && takesValue(activeBases.back().arg)));
+    makeCompletionSuggestion(bases, awaitsValue, args.size() > 1?args.back():std::string_view{});
 }
 
-auto parse(int argc, char const* const* argv, bool allowDashCombi = false) -> std::optional<std::string>;
-auto parse(std::span<std::string_view> args, bool allowDashCombi = false) -> std::optional<std::string>;
 
-inline auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<std::string> {
+CLICE_INLINE auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<std::string> {
     auto args   = std::list<std::string>{};
     auto argview = std::vector<std::string_view>{};
     bool allTrailing{false};
@@ -84,7 +291,7 @@ inline auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<
 
             // check each argument, if any option could/would take it
             auto foundArgs = std::set<std::string>{};
-            auto visitAllArguments = std::function<void(std::vector<ArgumentBase*> const&)>{};
+            auto visitAllArguments = std::function<void(ArgumentList const&)>{};
             visitAllArguments = [&](auto const& args) {
                 for (auto arg : args) {
                     for (auto const& e : arg->args) {
@@ -92,6 +299,7 @@ inline auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<
                             foundArgs.insert(e);
                         }
                     }
+                    arg->expandChildren();
                     visitAllArguments(arg->children);
                 }
             };
@@ -110,7 +318,7 @@ inline auto parseSingleDash(std::span<std::string_view> _args) -> std::optional<
     return parse(argview, false);
 }
 
-inline auto parseSingleDash(int _argc, char const* const* _argv) -> std::optional<std::string> {
+CLICE_INLINE auto parseSingleDash(int _argc, char const* const* _argv) -> std::optional<std::string> {
     auto args = std::vector<std::string_view>{};
     for (int i{0}; i < _argc; ++i) {
         args.emplace_back(_argv[i]);
@@ -119,25 +327,12 @@ inline auto parseSingleDash(int _argc, char const* const* _argv) -> std::optiona
 }
 
 
-// creates a string like "-i, --input"
-inline auto createParameterStrList(std::vector<std::string> const& args) -> std::string {
-    auto param = std::string{};
-    for (auto const& a : args) {
-        param += a + ", ";
-    }
-    if (param.size() > 1) {
-        param.pop_back();
-        param.pop_back();
-    }
-    return param;
-}
-
 
 /**
  * allowDashCombi: allows flags like "-a -b" be combined to "-ab"
  */
 
-inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std::optional<std::string> {
+CLICE_INLINE auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std::optional<std::string> {
     if (allowDashCombi) {
         return parseSingleDash(args);
     }
@@ -145,49 +340,107 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
 
     clice::argv0 = args[0];;
 
-    // check for symlink (only root arguments are considered)
+    // check for symlink (only root arguments are considered, see Register::symlinks)
     auto redirectedArguments = std::vector<std::string_view>{};
-    for (auto arg : Register::getInstance().arguments) {
-        if (arg->symlink and std::filesystem::path{argv0}.filename().string().ends_with("-" + arg->args[0])) {
-            redirectedArguments.push_back(args[0]);
-            redirectedArguments.push_back(arg->args[0].c_str());
-            for (size_t i{1}; i < args.size(); ++i) {
-                redirectedArguments.push_back(args[i]);
-            }
-            args = redirectedArguments;
-        }
+    if (auto arg = findSymlink(argv0); arg) {
+        redirectedArguments.reserve(args.size() + 1);
+        redirectedArguments.push_back(args[0]);
+        redirectedArguments.push_back(arg->args[0]);
+        redirectedArguments.insert(redirectedArguments.end(), args.begin() + 1, args.end());
+        args = redirectedArguments;
     }
 
     if (auto gen = std::getenv("CLICE_GENERATE_COMPLETION"); gen != nullptr) {
         printCompletion(gen);
         exit(0);
     }
+    if (auto shell = std::getenv("CLICE_GENERATE_STATIC_COMPLETION"); shell != nullptr) {
+        printStaticCompletion(shell);
+        exit(0);
+    }
+
+    if (std::getenv("CLICE_GENERATE_SCHEMA") != nullptr) {
+        auto out = fmt::memory_buffer{};
+        writeSchema(out);
+        std::fwrite(out.data(), 1, out.size(), stdout);
+        exit(0);
+    }
+    if (std::getenv("CLICE_GENERATE_EMBEDDED_HELP") != nullptr) {
+        printEmbeddedHelpSource();
+        exit(0);
+    }
+    if (std::getenv("CLICE_CHECK_EMBEDDED_HELP") != nullptr) {
+        exit(checkEmbeddedHelp()?0:1);
+    }
+
+    // completion mode: no environment variables, conversions or callbacks and no static destructors
+    if (std::getenv("CLICE_COMPLETION") != nullptr) {
+        if (args.size() > 1) {
+            completeArguments(args);
+        }
+        std::fflush(stdout);
+        std::_Exit(0);
+    }
+
+    // evaluates invocable values with .prefetch in the background (see prefetch.h)
+    startPrefetch();
+    struct JoinPrefetch {
+        ~JoinPrefetch() { waitPrefetch(); }
+    } joinPrefetch;
+
+    // state of an earlier clice::parse (see snapshot.h), argv and environment variables are not read
+    if (restoreSnapshotFromEnv()) {
+        return std::nullopt;
+    }
+
+    CLICE_PROBE1(parse__begin, args.size());
+    using Clock = std::chrono::steady_clock;
+    auto report       = ParseReport{};
+    enableProfileFromEnv();
+    auto profiling    = Profile::getInstance().format != ProfileFormat::None;
+    auto instrumented = parseReportSink or profiling;
+    auto parseStart   = instrumented?Clock::now():Clock::time_point{};
+    auto phaseStart   = parseStart;
+    auto lap = [&]() {
+        auto now = Clock::now();
+        auto d   = std::chrono::duration_cast<std::chrono::nanoseconds>(now - phaseStart);
+        phaseStart = now;
+        return d;
+    };
+
+    // parse() doesn't allocate for flags and numeric values, as long as these fit into the arena
+    auto arena    = std::array<std::byte, 4096>{};
+    auto resource = std::pmr::monotonic_buffer_resource{arena.data(), arena.size()};
+
+    // values of environment variables and argv replace the values of config files (lists would append to them)
+    auto init = [](ArgumentBase* arg) {
+        if (arg->fromConfig) {
+            arg->fromConfig = false;
+            if (arg->clearValue) arg->clearValue();
+        }
+        arg->init();
+    };
 
     // check environment variables first
-    {
-        using CB = std::function<void(ArgumentBase&, std::string)>;
-        auto visitAllArguments = std::function<void(std::vector<ArgumentBase*> const&, CB const&)>{};
-        visitAllArguments = [&](auto const& args, auto const& cb) {
-            for (auto arg : args) {
-                for (auto const& e : arg->env) {
-                    cb(*arg, e);
+    auto visitEnvironment = [&](auto const& self, ArgumentList const& args) -> void {
+        for (auto arg : args) {
+            for (auto const& env : arg->env) {
+                if (auto ptr = std::getenv(env.c_str()); ptr) {
+                    init(arg);
+                    ++report.conversions;
+                    arg->fromString(std::string_view{ptr});
                 }
-                visitAllArguments(arg->children, cb);
-            }
-        };
-        visitAllArguments(Register::getInstance().arguments, [&](ArgumentBase& arg, std::string env) {
-            if (auto ptr = std::getenv(env.c_str()); ptr) {
-                arg.init();
-                arg.fromString(std::string_view{ptr});
             }
-        });
-    }
+            self(self, arg->children);
+        }
+    };
+    visitEnvironment(visitEnvironment, Register::getInstance().arguments);
+    if (instrumented) report.environmentTime = lap();
+    CLICE_PROBE1(env__end, report.conversions);
 
 
     // parse args (argc/argv)
-    auto activeBases = std::vector<ArgumentBase*>{}; // current commands whos sub arguments are of interest;
-
-    auto completion = std::getenv("CLICE_COMPLETION") != nullptr;
+    auto activeBases = std::pmr::vector<ArgumentBase*>{&resource}; // current commands whos sub arguments are of interest;
 
     auto findRootArg = [&](std::string_view str) -> ArgumentBase* {
         for (auto arg : Register::getInstance().arguments) {
@@ -199,6 +452,15 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
         return nullptr;
     };
 
+    // selects arg, children of a lazy command are registered now and read their environment variables
+    auto activate = [&](ArgumentBase* arg) {
+        init(arg);
+        if (arg->expandChildren()) {
+            visitEnvironment(visitEnvironment, arg->children);
+        }
+        activeBases.push_back(arg);
+    };
+
     auto findActiveArg = [&](std::string_view str, ArgumentBase* base) -> ArgumentBase* {
         for (auto arg : base->children) {
             auto iter = std::find(arg->args.begin(), arg->args.end(), str);
@@ -212,11 +474,7 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
 
     bool allTrailing = false;
     for (size_t i{1}; i < args.size(); ++i) {
-        // make suggestion about next possible tokens
-        if (completion and i+1 == args.size()) {
-            makeCompletionSuggestion(activeBases, std::string_view{args[i]});
-            continue;
-        }
+        ++report.tokens;
         // A marking "--" indicates that all args[i] from now on are interpreted as values
         if (args[i] == "--" and !allTrailing) {
             allTrailing = true;
@@ -228,12 +486,12 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
             for (size_t j{0}; j < activeBases.size(); ++j) {
                 auto const& base = activeBases[activeBases.size()-j-1];
                 if (((!args[i].starts_with("-") or allTrailing or !base->tags.contains("multi")) and base->fromString) and (!base->tags.contains("multi") || base->args.size()>0 || allTrailing)) {
+                    ++report.conversions;
                     base->fromString(args[i]);
                     return;
                 }
                 if (auto arg = findActiveArg(args[i], base); arg) {
-                    arg->init();
-                    activeBases.push_back(arg);
+                    activate(arg);
                     return;
                 }
                 if (!base->tags.contains("multi") && base->fromString) {
@@ -247,8 +505,7 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
             }
             auto arg = findRootArg(args[i]);
             if (arg) {
-                arg->init();
-                activeBases.push_back(arg);
+                activate(arg);
                 return;
             }
             // check if an cli option without arguments exists
@@ -257,9 +514,9 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
                 auto const& base = activeBases[activeBases.size()-j-1];
                 for (auto arg : base->children) {
                     if (arg->args.empty() && arg->init) {
-                        arg->init();
+                        activate(arg);
                         if (!arg->tags.contains("multi")) arg->init = nullptr;
-                        activeBases.push_back(arg);
+                        ++report.conversions;
                         arg->fromString(args[i]);
                         return;
                     }
@@ -270,10 +527,10 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
             for (auto arg : Register::getInstance().arguments) {
                 if (arg->args.empty()) {
                     if (arg->init) {
-                        arg->init();
+                        activate(arg);
                         if (!arg->tags.contains("multi")) arg->init = nullptr;
 
-                        activeBases.push_back(arg);
+                        ++report.conversions;
                         arg->fromString(args[i]);
                         return;
                     }
@@ -284,6 +541,7 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
             for (size_t j{0}; j < activeBases.size(); ++j) {
                 auto const& base = activeBases[activeBases.size()-j-1];
                 if (base->tags.contains("multi") && base->fromString) {
+                    ++report.conversions;
                     base->fromString(args[i]);
                     return;
                 }
@@ -293,95 +551,52 @@ inline auto parse(std::span<std::string_view> args, bool allowDashCombi) -> std:
             throw std::runtime_error{std::string{"unexpected cli argument \""} + std::string{args[i]} + "\""};
         }();
     }
-    if (completion) {
-        exit(0);
-    }
-
-    // create list of all triggers according to priority
-    auto triggers = std::map<size_t, std::vector<std::tuple<clice::ArgumentBase*, std::function<void()>>>>{};
-    auto f = std::function<void(std::vector<clice::ArgumentBase*>)>{};
-    f = [&](auto const& args) {
-        for (auto arg : args) {
-            if (arg->cb) {
-                triggers[arg->cb_priority].emplace_back(arg, [=]() {
-                    arg->cb();
-                });
-            }
-            f(arg->children);
-        }
-    };
-    f(clice::Register::getInstance().arguments);
-
-    // trigger all calls that have a "ignore-required" tag
-    {
-        bool only_ignore = true;
-        for (auto const& [level, cbs] : triggers) {
-            for (auto const& [arg, cb] : cbs) {
-                if (!only_ignore && arg->tags.contains("ignore-required")) {
-                    throw std::runtime_error{"option " + arg->id + " could not run, since a higher priority option is missing a \"ignore-required\" tag"};
-                }
-                if (!arg->tags.contains("ignore-required")) {
-                    // do not execute any further callback
-                    only_ignore = false;
-                }
-                if (only_ignore) {
-                    cb();
-                }
+    if (instrumented) report.tokensTime = lap();
+    CLICE_PROBE2(tokens__end, report.tokens, report.conversions);
+
+    auto runCallback = [&](ArgumentBase const* arg) {
+        ++report.callbacks;
+        CLICE_PROBE2(callback__begin, arg, arg->args.empty()?arg->id.c_str():arg->args[0].c_str());
+        if (!instrumented) {
+            arg->cb();
+        } else {
+            if (profiling) {
+                beginProfileEntry(arg->args.empty()?arg->id:createParameterStrList(arg->args));
             }
-        }
-    }
-
-    // check if all active arguments got parameters
-    for (size_t j{0}; j < activeBases.size(); ++j) {
-        auto const& base = activeBases[activeBases.size()-j-1];
-        if (!base->tags.contains("multi") && base->fromString) {
-            auto param = createParameterStrList(base->args);
-            throw std::runtime_error{"option " + base->id + "\"" + param + "\" is missing a value (2)"};
-        }
-        for (auto child : base->children) {
-            if (child->tags.contains("required")) {
-                if (std::ranges::find(activeBases, child) == activeBases.end()) {
-                    auto option = createParameterStrList(base->args);
-                    auto suboption = createParameterStrList(child->args);
-                    throw std::runtime_error{"option " + child->id + "\"" + suboption + "\" is required (enforced by \"" + option + "\")"};
-                }
+            auto start    = Clock::now();
+            auto cpuStart = cpuTime();
+            arg->cb();
+            auto wall = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start);
+            auto cpu  = cpuTime() - cpuStart;
+            if (profiling) {
+                endProfileEntry();
             }
+            report.callbacksTime += wall;
+            report.callbackTimes.emplace_back(arg, wall, cpu);
         }
-    }
-
-    // check if all top level arguments got parameters
-    for (auto base : Register::getInstance().arguments) {
-        if (base->tags.contains("required")) {
-            if (std::ranges::find(activeBases, base) == activeBases.end()) {
-                auto option = createParameterStrList(base->args);
-                throw std::runtime_error{"option " + base->id + " \"" + option + "\" is a required parameter"};
-            }
-        }
-    }
+        CLICE_PROBE2(callback__end, arg, arg->args.empty()?arg->id.c_str():arg->args[0].c_str());
+    };
 
+    auto validated = [&]() {
+        // validation time without the "ignore-required" callbacks
+        if (instrumented) report.validationTime = lap() - report.callbacksTime;
+    };
+    // std::ref: the lambdas are stored in std::function without allocating
+    runTriggers(activeBases, std::ref(runCallback), std::ref(validated), &resource);
 
-    // call triggers in priority level order
-    for (auto const& [level, cbs] : triggers) {
-        for (auto const& [arg, cb] : cbs) {
-            if (!arg->tags.contains("ignore-required")) {
-                cb();
-            }
-        }
+    CLICE_PROBE1(parse__end, report.callbacks);
+    if (parseReportSink) {
+        report.totalTime = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - parseStart);
+        parseReportSink(report);
     }
-
     return std::nullopt;
 }
 
-struct Parse {
-    std::tuple<int, char const* const*> args;
-    std::string desc;            // description of the tool
-    bool allowDashCombi{false};  // allows to combine "-a -b" into "-ab"
-    bool helpOpt{false};         // automatically registers --help option
-    bool catchExceptions{false}; // catches exception and prints them
-    std::function<void()> run{}; // function to run
-};
-inline auto parse(int argc, char const* const* argv, bool allowDashCombi) -> std::optional<std::string> {
-    auto args = std::vector<std::string_view>{};
+CLICE_INLINE auto parse(int argc, char const* const* argv, bool allowDashCombi) -> std::optional<std::string> {
+    auto arena    = std::array<std::byte, 2048>{};
+    auto resource = std::pmr::monotonic_buffer_resource{arena.data(), arena.size()};
+    auto args     = std::pmr::vector<std::string_view>{&resource};
+    args.reserve(argc);
     for (int i{0}; i < argc; ++i) {
         args.emplace_back(argv[i]);
     }
@@ -389,8 +604,17 @@ inline auto parse(int argc, char const* const* argv, bool allowDashCombi) -> std
 }
 
 
-inline void parse(Parse const& parse) {
+CLICE_INLINE void parse(Parse const& parse) {
     auto f = [&]() {
+        enableProfile(parse.profile);
+        // loaded before clice::parse reads the environment and argv: CLI > env > config > default
+        if (std::getenv("CLICE_COMPLETION") == nullptr) {
+            for (auto const& path : parse.config) {
+                if (std::filesystem::exists(path)) {
+                    loadConfig(path);
+                }
+            }
+        }
         auto [argc, argv] = parse.args;
         if (auto failed = clice::parse(argc, argv, parse.allowDashCombi); failed) {
             std::cerr << "parsing failed: " << *failed << "\n";
@@ -398,7 +622,10 @@ inline void parse(Parse const& parse) {
         }
 
         if (parse.run) {
+            auto profiling = Profile::getInstance().format != ProfileFormat::None;
+            if (profiling) beginProfileEntry("<run>");
             parse.run();
+            if (profiling) endProfileEntry();
         }
     };
 
@@ -409,7 +636,9 @@ inline void parse(Parse const& parse) {
                                                 if (parse.desc.size()) {
                                                     std::cout << parse.desc << "\n\n";
                                                 }
-                                                std::cout << generateHelp(); exit(0);
+                                                // "tool sub --help" only prints the help of "sub"
+                                                printHelp(selectedCommand());
+                                                exit(0);
                                             },
                                            .cb_priority = 5,
                                            .tags   = {"ignore-required"},
@@ -440,4 +669,5 @@ inline void parse(Parse const& parse) {
         }
     }
 }
+#endif
 }
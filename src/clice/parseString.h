@@ -2,12 +2,20 @@
 // SPDX-License-Identifier: ISC
 #pragma once
 
+#include "config.h"
+
 #include <algorithm>
+#include <array>
+#include <cctype>
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
 #include <filesystem>
 #include <numbers>
 #include <optional>
 #include <ranges>
 #include <sstream>
+#include <stdexcept>
 #include <string>
 #include <string_view>
 
@@ -86,10 +94,39 @@ auto parseSuffix(std::string_view suffix) -> std::optional<T> {
     return {ret};
 }
 
+/**
+ * Copy of a number without ' separators, null terminated for strtoll/strtoull.
+ * Short numbers are kept on the stack, so parsing them doesn't allocate.
+ */
+struct NumberString {
+    std::array<char, 64> small;
+    std::string          large;
+    char*                data{};
+    size_t               size{};
+
+    explicit NumberString(std::string_view str) {
+        data = small.data();
+        if (str.size() >= small.size()) {
+            large.resize(str.size());
+            data = large.data();
+        }
+        for (auto c : str) {
+            if (c != '\'') data[size++] = c;
+        }
+        data[size] = '\0';
+    }
+    NumberString(NumberString const&) = delete;
+    auto operator=(NumberString const&) -> NumberString& = delete;
+
+    auto view() const -> std::string_view {
+        return {data, size};
+    }
+};
+
 template<typename T>
 auto parseFromString(std::string_view _str) -> T {
-    auto str = std::string{_str};
     if constexpr (std::is_same_v<T, bool>) {
+        auto str = std::string{_str};
         std::ranges::transform(str, str.begin(), ::tolower);
         if (str == "true" or str == "1" or str == "yes") {
             return true;
@@ -99,12 +136,12 @@ auto parseFromString(std::string_view _str) -> T {
         }
         throw std::runtime_error{std::string{"invalid boolean specifier \""} + str + "\""};
     } else if constexpr (std::is_same_v<T, std::string>) {
-        return str;
+        return std::string{_str};
     } else if constexpr (std::is_same_v<T, std::filesystem::path>) {
-        return str;
+        return std::string{_str};
     } else if constexpr (std::is_same_v<T, char>) {
         if (_str.size() != 1) {
-            throw std::runtime_error{std::string{"invalid char specifier, must be exactly one char \""} + str + "\""};
+            throw std::runtime_error{std::string{"invalid char specifier, must be exactly one char \""} + std::string{_str} + "\""};
         }
         return _str[0];
     } else if constexpr (std::numeric_limits<T>::is_exact) {
@@ -112,32 +149,37 @@ auto parseFromString(std::string_view _str) -> T {
         auto ret = T{};
 
         // remove potential ' separator
-        str.erase(std::remove(str.begin(), str.end(), '\''), str.end());
+        auto number = NumberString{_str};
+        auto str    = number.view();
 
         auto base = int{0};
-        char const* strBegin = str.data();
-        char const* strEnd   = str.data() + str.size();
-        std::size_t nextIdx=0;
-        if (str.find("0b") == 0) {
+        char const* strBegin = number.data;
+        char const* strEnd   = number.data + number.size;
+        if (str.starts_with("0b")) {
             base = 2;
             strBegin += 2;
         }
-        try {
-            if constexpr (std::is_unsigned_v<T>) {
-                ret = std::stoull(strBegin, &nextIdx, base);
-            } else {
-                ret = std::stoll(strBegin, &nextIdx, base);
-            }
-        } catch (std::invalid_argument const&) {
-            throw std::runtime_error{std::string{"not a valid integer \""} + str + "\""};
+        // same as std::stoll/std::stoull, but without allocating a std::string
+        char* next{};
+        errno = 0;
+        if constexpr (std::is_unsigned_v<T>) {
+            ret = std::strtoull(strBegin, &next, base);
+        } else {
+            ret = std::strtoll(strBegin, &next, base);
+        }
+        if (next == strBegin) {
+            throw std::runtime_error{std::string{"not a valid integer \""} + std::string{str} + "\""};
+        }
+        if (errno == ERANGE) {
+            throw std::out_of_range{std::is_unsigned_v<T>?"stoull":"stoll"};
         }
         // if we didn't parse everything check if it has some known suffix
-        if (static_cast<int>(nextIdx) != strEnd - strBegin) {
+        if (next != strEnd) {
             if constexpr (not std::is_same_v<bool, T>) {
-                auto suffix = std::string_view{strBegin + nextIdx};
+                auto suffix = std::string_view{next};
                 auto value = parseSuffix<T>(suffix);
                 if (not value) {
-                    throw std::runtime_error{std::string{"unknown integer suffix \""} + str + "\""};
+                    throw std::runtime_error{std::string{"unknown integer suffix \""} + std::string{str} + "\""};
                 }
                 ret *= value.value();
             }
@@ -148,26 +190,60 @@ auto parseFromString(std::string_view _str) -> T {
         using UT = std::underlying_type_t<T>;
         auto ret = UT{};
         // parse everything else
-        auto ss = std::stringstream{str};
+        auto ss = std::stringstream{std::string{_str}};
         if (not (ss >> ret)) {
             throw std::runtime_error{std::string{"error parsing cli"}};
         }
         return T(ret);
     } else if constexpr (std::floating_point<T>) {
         // remove potential ' separator
-        str.erase(std::remove(str.begin(), str.end(), '\''), str.end());
+        auto number = NumberString{_str};
+        auto str    = number.view();
 
-        auto ret = T{};
-        auto ss = std::stringstream{str};
+        auto ret  = T{};
+        auto rest = std::string_view{}; // everything after the number
+#ifdef __cpp_lib_to_chars
+        // accepts the same as 'std::istream >> ret', but doesn't allocate
+        auto first = str.data();
+        auto last  = str.data() + str.size();
+        while (first != last and std::isspace(static_cast<unsigned char>(*first))) ++first;
+        auto digits = first;
+        if (digits != last and *digits == '+') first = ++digits;
+        else if (digits != last and *digits == '-') ++digits;
+        if (digits == last or not (std::isdigit(static_cast<unsigned char>(*digits)) or *digits == '.')) {
+            throw std::runtime_error{std::string{"error parsing cli"}};
+        }
+        auto [ptr, ec] = std::from_chars(first, last, ret);
+        auto exponent  = std::find_if(first, ptr, [](char c) { return c == 'e' or c == 'E'; });
+        if (ec == std::errc::result_out_of_range and exponent != ptr and exponent[1] == '-') {
+            ret = (*first == '-')?-T{}:T{}; // underflow
+        } else if (ec != std::errc{}) {
+            throw std::runtime_error{std::string{"error parsing cli"}};
+        }
+        rest = std::string_view{ptr, last};
+        // operator>> would have read it as incomplete exponent
+        if (rest.starts_with('e') or rest.starts_with('E')) {
+            throw std::runtime_error{std::string{"error parsing cli"}};
+        }
+#else
+        auto ss = std::stringstream{std::string{str}};
         if (not (ss >> ret)) {
             throw std::runtime_error{std::string{"error parsing cli"}};
         }
-        // parse floats/doubles and convert if they are angles or have other suffices
         if (not ss.eof()) {
-            auto ending = std::string{};
-            if (not (ss >> ending)) {
-                throw std::runtime_error{std::string{"invalid string \""} + str + "\""};
+            rest = str.substr(static_cast<size_t>(ss.tellg()));
+        }
+#endif
+        // parse floats/doubles and convert if they are angles or have other suffices
+        if (not rest.empty()) {
+            // the suffix is the next word
+            auto const whitespace = std::string_view{" \t\n\v\f\r"};
+            auto begin = rest.find_first_not_of(whitespace);
+            if (begin == std::string_view::npos) {
+                throw std::runtime_error{std::string{"invalid string \""} + std::string{str} + "\""};
             }
+            auto ending = rest.substr(begin);
+            ending = ending.substr(0, ending.find_first_of(whitespace));
             if (ending.ends_with("rad")) {
                 ending = ending.substr(0, ending.size()-3);
             } else if (ending.ends_with("deg")) {
@@ -187,7 +263,7 @@ auto parseFromString(std::string_view _str) -> T {
             if (ending.size()) {
                 auto value = parseSuffix<T>(ending);
                 if (!value) {
-                    throw std::runtime_error{std::string{"unknown floating-point suffix \""} + str + "\""};
+                    throw std::runtime_error{std::string{"unknown floating-point suffix \""} + std::string{str} + "\""};
                 }
                 ret = ret * value.value();
             }
@@ -196,7 +272,7 @@ auto parseFromString(std::string_view _str) -> T {
     } else {
         // parse everything else
         auto ret = T{};
-        auto ss = std::stringstream{str};
+        auto ss = std::stringstream{std::string{_str}};
         if (not (ss >> ret)) {
             throw std::runtime_error{std::string{"error parsing cli"}};
         }
@@ -208,4 +284,16 @@ auto parseFromString(std::string_view _str) -> T {
     }
 }
 
+// value types whose conversions are compiled into libclice, see config.h
+#define CLICE_BUILTIN_VALUE_TYPES(X) \
+    X(bool) X(char) X(signed char) X(unsigned char) X(short) X(unsigned short) X(int) X(unsigned int) \
+    X(long) X(unsigned long) X(long long) X(unsigned long long) X(float) X(double) \
+    X(std::string) X(std::filesystem::path)
+
+#if !CLICE_DEFINITIONS
+#define CLICE_EXTERN_PARSE_FROM_STRING(T) extern template auto parseFromString<T>(std::string_view) -> T;
+CLICE_BUILTIN_VALUE_TYPES(CLICE_EXTERN_PARSE_FROM_STRING)
+#undef CLICE_EXTERN_PARSE_FROM_STRING
+#endif
+
 }
@@ -0,0 +1,64 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+#include "config.h"
+
+#include <cstdlib>
+#include <thread>
+#include <vector>
+
+namespace clice {
+
+/**
+ * Prefetching of invocable values
+ *
+ *   auto cliThreads = clice::Argument{ .args = "--threads", .value = []() { return detectNumCores(); }, .prefetch = true };
+ *
+ * clice::parse starts a background thread evaluating all invocable values with .prefetch, while
+ * it reads the environment, argv and runs the callbacks. The results are published through
+ * LazyValue (see lazyValue.h): a dereference during parse waits for a running evaluation, a value
+ * given on the command line replaces it. clice::parse joins the thread before returning (also if
+ * a callback calls exit()), so the critical path is the longer of both instead of their sum.
+ *
+ * The invocable runs before the arguments are parsed, it must not depend on other arguments.
+ * Exceptions are dropped, the first dereference evaluates the value again.
+ */
+struct PrefetchThread {
+    std::thread thread;
+
+    static auto getInstance() -> PrefetchThread& {
+        static PrefetchThread instance;
+        return instance;
+    }
+};
+
+CLICE_INLINE void startPrefetch();
+CLICE_INLINE void waitPrefetch();
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE void startPrefetch() {
+    auto const& args = Register::getInstance().prefetch;
+    if (args.empty()) return;
+    waitPrefetch();
+    // registered after PrefetchThread was constructed, so it runs before its destructor
+    [[maybe_unused]] static auto registered = std::atexit(&waitPrefetch);
+    PrefetchThread::getInstance().thread = std::thread{[args = args]() {
+        for (auto arg : args) {
+            try {
+                arg->prefetchValue();
+            } catch (...) {}
+        }
+    }};
+}
+
+CLICE_INLINE void waitPrefetch() {
+    auto& thread = PrefetchThread::getInstance().thread;
+    if (thread.joinable()) {
+        thread.join();
+    }
+}
+#endif
+
+}
@@ -5,11 +5,36 @@
 #include "Argument.h"
 
 #include <cassert>
+#include <cctype>
 #include <fmt/format.h>
+#include <fmt/ranges.h>
+#include <functional>
 
 namespace clice {
 
-inline void printCompletion(std::string gen) {
+/**
+ * Static completion scripts
+ *
+ * The scripts generated by printCompletion re-execute the program on every TAB press.
+ * printStaticCompletion serializes the whole argument tree into the script instead,
+ * only arguments with a '.completion' callback still call back into the binary.
+ */
+struct StaticCompletionNode {
+    ArgumentBase const* arg{};      // nullptr for the program itself
+    std::vector<size_t> children{}; // indices into the node list
+};
+
+CLICE_INLINE void printCompletion(std::string gen);
+CLICE_INLINE auto collectStaticCompletionNodes() -> std::vector<StaticCompletionNode>;
+CLICE_INLINE auto staticCompletionKind(StaticCompletionNode const& node) -> int;
+CLICE_INLINE auto staticCompletionHint(StaticCompletionNode const& node) -> std::string;
+CLICE_INLINE auto staticCompletionOptions(std::vector<StaticCompletionNode> const& nodes, StaticCompletionNode const& node) -> std::string;
+CLICE_INLINE auto shellQuote(std::string_view str) -> std::string;
+CLICE_INLINE auto fishQuote(std::string_view str) -> std::string;
+CLICE_INLINE void printStaticCompletion(std::string_view shell);
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE void printCompletion(std::string gen) {
     auto path = std::filesystem::path{fmt::format("/proc/{}/exe", gen)};
     if (is_symlink(path)) {
         path = read_symlink(path);
@@ -41,13 +66,8 @@ R"(function clice_GetOpts ()
         parts=(${HINTS[0]})
         EXT="${parts[1]}"
 
-        HINTS=$(printf "%q:" "${HINTS[@]}")
-        unset HINTS[0]
-        unset HINTS[1]
-        local IFS=":"
-        if [ ${#HINTS[@]} -gt 0 ]; then
-            readarray -t COMPREPLY <<< $(compgen -W '${HINTS[@]}' -- "${WORD_TO_COMPLETE}")
-        fi
+        # hints after the first line are already filtered by the word to complete
+        COMPREPLY=( "${HINTS[@]:1}" )
 
         local IFS=$'\n'
         COMPREPLY+=( $(compgen -d -- ${2}) )
@@ -56,9 +76,8 @@ R"(function clice_GetOpts ()
     elif [ ${#HINTS} -eq 0 ]; then
         COMPREPLY=()
     else
-        HINTS=$(printf "%q:" "${HINTS[@]}")
-        local IFS=":"
-        mapfile -t COMPREPLY <<< $(compgen -W '${HINTS[@]}' -- "${WORD_TO_COMPLETE}")
+        # hints are already filtered by the word to complete
+        COMPREPLY=( "${HINTS[@]}" )
     fi
 })", argv0);
     } else if (gen == std::string{"zsh"}) {
@@ -75,7 +94,7 @@ R"abc(clice_GetOpts () {
         EXT="$(echo "${completions}" | cut -d ' ' -f 3)"
         _files -g "*${EXT}"
     else
-        compadd -- "${completions[@]}"
+        compadd -U -- "${completions[@]}"
     fi
 })abc", argv0, argv0);
     } else {
@@ -84,4 +103,301 @@ R"abc(clice_GetOpts () {
     }
 }
 
+
+// flattens the argument tree, node 0 is the program itself
+CLICE_INLINE auto collectStaticCompletionNodes() -> std::vector<StaticCompletionNode> {
+    auto nodes = std::vector<StaticCompletionNode>(1);
+    auto f = std::function<void(ArgumentList const&, size_t)>{};
+    f = [&](auto const& args, size_t parent) {
+        for (auto arg : args) {
+            auto id = nodes.size();
+            nodes.push_back({.arg = arg});
+            nodes[parent].children.push_back(id);
+            arg->expandChildren();
+            f(arg->children, id);
+        }
+    };
+    f(Register::getInstance().arguments, 0);
+    return nodes;
+}
+
+// 0: takes no value, 1: takes a single value, 2: takes multiple values
+CLICE_INLINE auto staticCompletionKind(StaticCompletionNode const& node) -> int {
+    if (!node.arg || node.arg->type->kind == TypeKind::Flag) return 0;
+    if (node.arg->tags.contains("multi")) return 2;
+    return 1;
+}
+
+// "@files", "@dynamic" or a newline separated list of values
+CLICE_INLINE auto staticCompletionHint(StaticCompletionNode const& node) -> std::string {
+    if (!node.arg) return "";
+    if (node.arg->completion_fn) return "@dynamic";
+    if (node.arg->mapping) {
+        auto keys = *node.arg->mapping;
+        std::ranges::sort(keys);
+        return fmt::format("{}", fmt::join(keys, "\n"));
+    }
+    if (node.arg->type->completion == CompletionHint::Files) return "@files";
+    return "";
+}
+
+// newline separated list of the primary alias of each child
+CLICE_INLINE auto staticCompletionOptions(std::vector<StaticCompletionNode> const& nodes, StaticCompletionNode const& node) -> std::string {
+    auto options = std::vector<std::string>{};
+    for (auto c : node.children) {
+        if (!nodes[c].arg->args.empty()) {
+            options.push_back(nodes[c].arg->args[0]);
+        }
+    }
+    std::ranges::sort(options);
+    return fmt::format("{}", fmt::join(options, "\n"));
+}
+
+// quotes a string for bash/zsh
+CLICE_INLINE auto shellQuote(std::string_view str) -> std::string {
+    auto ret = std::string{"'"};
+    for (auto c : str) {
+        if (c == '\'') ret += "'\\''";
+        else ret += c;
+    }
+    return ret + "'";
+}
+
+// quotes a string for fish
+CLICE_INLINE auto fishQuote(std::string_view str) -> std::string {
+    auto ret = std::string{"'"};
+    for (auto c : str) {
+        if (c == '\'' || c == '\\') ret += '\\';
+        ret += c;
+    }
+    return ret + "'";
+}
+
+CLICE_INLINE void printStaticCompletion(std::string_view shell) {
+    auto name = std::filesystem::path{argv0}.filename().string();
+    auto fn   = std::string{"_clice_"};
+    for (auto c : name) {
+        fn += std::isalnum(static_cast<unsigned char>(c))?c:'_';
+    }
+    auto nodes = collectStaticCompletionNodes();
+
+    if (shell == "bash" || shell == "zsh") {
+        bool bash = shell == "bash";
+        auto assign = [&](std::string const& key, std::string const& value) {
+            if (bash) return fmt::format("    [{}]={}\n", shellQuote(key), shellQuote(value));
+            return fmt::format("    {} {}\n", shellQuote(key), shellQuote(value));
+        };
+        auto child = std::string{};
+        auto kind  = std::string{};
+        auto opts  = std::string{};
+        auto hint  = std::string{};
+        for (size_t i{0}; i < nodes.size(); ++i) {
+            for (auto c : nodes[i].children) {
+                for (auto const& a : nodes[c].arg->args) {
+                    child += assign(fmt::format("{} {}", i, a), std::to_string(c));
+                }
+            }
+            kind += assign(std::to_string(i), std::to_string(staticCompletionKind(nodes[i])));
+            opts += assign(std::to_string(i), staticCompletionOptions(nodes, nodes[i]));
+            if (auto h = staticCompletionHint(nodes[i]); !h.empty()) {
+                hint += assign(std::to_string(i), h);
+            }
+        }
+        if (bash) {
+            fmt::print("declare -gA {0}_child=(\n{1})\ndeclare -gA {0}_kind=(\n{2})\ndeclare -gA {0}_opts=(\n{3})\ndeclare -gA {0}_hint=(\n{4})\n", fn, child, kind, opts, hint);
+            fmt::print(R"abc(function {0} ()
+{{
+    local cur="${{COMP_WORDS[COMP_CWORD]}}"
+    local -a stack=() words=()
+    local pending=0 top=0 i j w key next hint
+
+    # walk the words before the cursor through the argument tree
+    for (( i=1; i < COMP_CWORD; ++i )); do
+        w="${{COMP_WORDS[i]}}"
+        if [ ${{pending}} -eq 1 ] || {{ [ ${{pending}} -eq 2 ] && [ "${{w:0:1}}" != "-" ]; }}; then
+            [ ${{pending}} -eq 1 ] && pending=0
+            continue
+        fi
+        next=""
+        for (( j=${{#stack[@]}}-1; j >= 0 && ${{#next}} == 0; --j )); do
+            key="${{stack[j]}} ${{w}}"
+            next="${{{0}_child["${{key}}"]}}"
+        done
+        if [ -z "${{next}}" ]; then
+            key="0 ${{w}}"
+            next="${{{0}_child["${{key}}"]}}"
+        fi
+        if [ -n "${{next}}" ]; then
+            stack+=("${{next}}")
+            pending="${{{0}_kind[${{next}}]}}"
+        fi
+    done
+    [ ${{#stack[@]}} -gt 0 ] && top="${{stack[-1]}}"
+
+    COMPREPLY=()
+    local IFS=$'\n'
+    if [ ${{pending}} -ne 0 ] && [ "${{cur:0:1}}" != "-" ]; then
+        hint="${{{0}_hint[${{top}}]}}"
+        if [ "${{hint}}" == "@files" ]; then
+            compopt -o filenames
+            COMPREPLY=( $(compgen -f -- "${{cur}}") )
+            return
+        elif [ "${{hint}}" == "@dynamic" ]; then
+            local LINE="${{COMP_LINE:0:COMP_POINT}}"
+            [ -z "${{cur}}" ] && LINE="${{LINE}} ''"
+            readarray -t words <<< "$(CLICE_COMPLETION= eval ${{LINE}} 2>/dev/null)"
+            # already filtered by the program
+            for w in "${{words[@]}}"; do
+                [ -n "${{w}}" ] && COMPREPLY+=("${{w}}")
+            done
+            return
+        elif [ -n "${{hint}}" ]; then
+            readarray -t words <<< "${{hint}}"
+        fi
+    fi
+    if [ ${{#words[@]}} -eq 0 ]; then
+        hint="${{{0}_opts[0]}}"
+        for j in "${{stack[@]}}"; do
+            hint+=$'\n'"${{{0}_opts[${{j}}]}}"
+        done
+        readarray -t words <<< "${{hint}}"
+    fi
+    for w in "${{words[@]}}"; do
+        [ -n "${{w}}" ] && [[ "${{w}}" == "${{cur}}"* ]] && COMPREPLY+=("${{w}}")
+    done
+}}
+complete -F {0} {1}
+)abc", fn, name);
+        } else {
+            fmt::print("typeset -gA {0}_child {0}_kind {0}_opts {0}_hint\n{0}_child=(\n{1})\n{0}_kind=(\n{2})\n{0}_opts=(\n{3})\n{0}_hint=(\n{4})\n", fn, child, kind, opts, hint);
+            fmt::print(R"abc({0} () {{
+    local cur="${{words[CURRENT]}}"
+    local -a stack completions
+    local pending=0 top=0 i j w key next hint
+
+    # walk the words before the cursor through the argument tree
+    for (( i=2; i < CURRENT; ++i )); do
+        w="${{words[i]}}"
+        if (( pending == 1 )) || {{ (( pending == 2 )) && [[ "${{w[1]}}" != "-" ]]; }}; then
+            (( pending == 1 )) && pending=0
+            continue
+        fi
+        next=""
+        for (( j=${{#stack}}; j >= 1 && ${{#next}} == 0; --j )); do
+            key="${{stack[j]}} ${{w}}"
+            next="${{{0}_child[$key]}}"
+        done
+        if [[ -z "${{next}}" ]]; then
+            key="0 ${{w}}"
+            next="${{{0}_child[$key]}}"
+        fi
+        if [[ -n "${{next}}" ]]; then
+            stack+=("${{next}}")
+            pending="${{{0}_kind[$next]}}"
+        fi
+    done
+    (( ${{#stack}} > 0 )) && top="${{stack[-1]}}"
+
+    if (( pending != 0 )) && [[ "${{cur[1]}}" != "-" ]]; then
+        hint="${{{0}_hint[$top]}}"
+        if [[ "${{hint}}" == "@files" ]]; then
+            _files
+            return
+        elif [[ "${{hint}}" == "@dynamic" ]]; then
+            # already filtered by the program
+            compadd -U -- ${{(f)"$(CLICE_COMPLETION= "${{(@)words[1,CURRENT]}}" 2>/dev/null)"}}
+            return
+        elif [[ -n "${{hint}}" ]]; then
+            completions=(${{(f)hint}})
+        fi
+    fi
+    if (( ${{#completions}} == 0 )); then
+        hint="${{{0}_opts[0]}}"
+        for j in "${{stack[@]}}"; do
+            hint+=$'\n'"${{{0}_opts[$j]}}"
+        done
+        completions=(${{(f)hint}})
+    fi
+    compadd -- "${{completions[@]}}"
+}}
+compdef {0} {1}
+)abc", fn, name);
+        }
+    } else if (shell == "fish") {
+        auto keys = std::string{};
+        auto vals = std::string{};
+        auto kind = std::string{};
+        auto opts = std::string{};
+        auto hint = std::string{};
+        for (size_t i{0}; i < nodes.size(); ++i) {
+            for (auto c : nodes[i].children) {
+                for (auto const& a : nodes[c].arg->args) {
+                    keys += " " + fishQuote(fmt::format("{} {}", i, a));
+                    vals += fmt::format(" {}", c);
+                }
+            }
+            kind += fmt::format(" {}", staticCompletionKind(nodes[i]));
+            opts += " " + fishQuote(staticCompletionOptions(nodes, nodes[i]));
+            hint += " " + fishQuote(staticCompletionHint(nodes[i]));
+        }
+        fmt::print("set -g {0}_child_keys{1}\nset -g {0}_child_vals{2}\nset -g {0}_kind{3}\nset -g {0}_opts{4}\nset -g {0}_hint{5}\n", fn, keys, vals, kind, opts, hint);
+        fmt::print(R"abc(function {0}
+    set -l tokens (commandline -opc)
+    set -l cur (commandline -ct)
+    set -l stack
+    set -l pending 0
+    set -l top 0
+
+    # walk the words before the cursor through the argument tree
+    for w in $tokens[2..-1]
+        if test $pending -eq 1; or begin; test $pending -eq 2; and not string match -q -- '-*' $w; end
+            test $pending -eq 1; and set pending 0
+            continue
+        end
+        set -l next
+        for j in (seq (count $stack) -1 1)
+            set -l idx (contains -i -- "$stack[$j] $w" ${0}_child_keys)
+            and set next ${0}_child_vals[$idx]
+            and break
+        end
+        if test -z "$next"
+            set -l idx (contains -i -- "0 $w" ${0}_child_keys)
+            and set next ${0}_child_vals[$idx]
+        end
+        if test -n "$next"
+            set -a stack $next
+            set pending ${0}_kind[(math $next + 1)]
+        end
+    end
+    test (count $stack) -gt 0; and set top $stack[-1]
+
+    if test $pending -ne 0; and not string match -q -- '-*' "$cur"
+        set -l hint ${0}_hint[(math $top + 1)]
+        switch "$hint"
+            case '@files'
+                __fish_complete_path "$cur"
+                return
+            case '@dynamic'
+                env CLICE_COMPLETION= $tokens "$cur" 2>/dev/null
+                return
+            case ''
+            case '*'
+                string split -n \n -- $hint
+                return
+        end
+    end
+    string split -n \n -- ${0}_opts[1]
+    for j in $stack
+        string split -n \n -- ${0}_opts[(math $j + 1)]
+    end
+end
+complete -c {1} -f -a '({0})'
+)abc", fn, name);
+    } else {
+        fmt::print("unknown generator for shell '{}'\n", shell);
+        exit(1);
+    }
+}
+#endif
+
 }
@@ -0,0 +1,149 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "config.h"
+#include "generateSchema.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fmt/format.h>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clice {
+
+/**
+ * Profile of callbacks
+ *
+ * Enabled by CLICE_PROFILE ("json" for JSON, any other value for text) or Parse::profile.
+ * clice::parse then times every callback (including those tagged "ignore-required") and
+ * Parse::run with wall and CPU time. At exit the entries are summed per argument and
+ * printed sorted by wall time to stderr, or to the file CLICE_PROFILE_FILE:
+ *
+ *   {"clice-profile":1,"entries":[{"name":"-i, --index","calls":1,"wall_ns":...,"cpu_ns":...}...]}
+ */
+enum class ProfileFormat { None, Text, Json };
+
+struct ProfileEntry {
+    std::string              name;  // aliases of the argument, "<run>" for Parse::run
+    size_t                   calls{};
+    std::chrono::nanoseconds wall{};
+    std::chrono::nanoseconds cpu{};
+};
+
+struct Profile {
+    struct Running {
+        std::string                           name;
+        std::chrono::steady_clock::time_point start;
+        std::chrono::nanoseconds              cpuStart;
+    };
+
+    ProfileFormat             format{ProfileFormat::None};
+    std::vector<ProfileEntry> entries;
+    std::optional<Running>    running; // callback that is currently executed, it might call exit()
+
+    static auto getInstance() -> Profile& {
+        static Profile instance;
+        return instance;
+    }
+};
+
+CLICE_INLINE auto cpuTime() -> std::chrono::nanoseconds;
+CLICE_INLINE void enableProfile(ProfileFormat format);
+CLICE_INLINE void enableProfileFromEnv();
+CLICE_INLINE void recordProfile(std::string_view name, std::chrono::nanoseconds wall, std::chrono::nanoseconds cpu);
+CLICE_INLINE void beginProfileEntry(std::string name);
+CLICE_INLINE void endProfileEntry();
+CLICE_INLINE auto renderProfile(ProfileFormat format) -> std::string;
+CLICE_INLINE void printProfile();
+
+#if CLICE_DEFINITIONS
+// CPU time of the process, see std::clock
+CLICE_INLINE auto cpuTime() -> std::chrono::nanoseconds {
+    return std::chrono::nanoseconds{static_cast<int64_t>(std::clock() * (1'000'000'000. / CLOCKS_PER_SEC))};
+}
+
+// prints the profile at exit, the first call decides the format
+CLICE_INLINE void enableProfile(ProfileFormat format) {
+    auto& profile = Profile::getInstance();
+    if (format == ProfileFormat::None or profile.format != ProfileFormat::None) return;
+    profile.format = format;
+    std::atexit(&printProfile);
+}
+
+CLICE_INLINE void enableProfileFromEnv() {
+    if (auto ptr = std::getenv("CLICE_PROFILE"); ptr and *ptr) {
+        enableProfile(std::string_view{ptr} == "json"?ProfileFormat::Json:ProfileFormat::Text);
+    }
+}
+
+CLICE_INLINE void recordProfile(std::string_view name, std::chrono::nanoseconds wall, std::chrono::nanoseconds cpu) {
+    auto& entries = Profile::getInstance().entries;
+    auto iter = std::ranges::find(entries, name, &ProfileEntry::name);
+    if (iter == entries.end()) {
+        iter = entries.insert(entries.end(), ProfileEntry{.name = std::string{name}});
+    }
+    iter->calls += 1;
+    iter->wall  += wall;
+    iter->cpu   += cpu;
+}
+
+CLICE_INLINE void beginProfileEntry(std::string name) {
+    Profile::getInstance().running = Profile::Running{std::move(name), std::chrono::steady_clock::now(), cpuTime()};
+}
+
+CLICE_INLINE void endProfileEntry() {
+    auto& running = Profile::getInstance().running;
+    if (!running) return;
+    recordProfile(running->name, std::chrono::steady_clock::now() - running->start, cpuTime() - running->cpuStart);
+    running.reset();
+}
+
+CLICE_INLINE auto renderProfile(ProfileFormat format) -> std::string {
+    auto entries = Profile::getInstance().entries;
+    std::ranges::stable_sort(entries, std::greater{}, &ProfileEntry::wall);
+
+    auto out = fmt::memory_buffer{};
+    if (format == ProfileFormat::Json) {
+        out.append(std::string_view{"{\"clice-profile\":1,\"entries\":["});
+        for (size_t i{0}; i < entries.size(); ++i) {
+            if (i > 0) out.push_back(',');
+            out.append(std::string_view{"{\"name\":"});
+            writeJsonString(out, entries[i].name);
+            formatTo(out, ",\"calls\":{},\"wall_ns\":{},\"cpu_ns\":{}}}", entries[i].calls, entries[i].wall.count(), entries[i].cpu.count());
+        }
+        out.append(std::string_view{"]}\n"});
+    } else {
+        formatTo(out, "clice profile\n{:>12} {:>12} {:>6}  {}\n", "wall[ms]", "cpu[ms]", "calls", "argument");
+        for (auto const& e : entries) {
+            formatTo(out, "{:>12.3f} {:>12.3f} {:>6}  {}\n", e.wall.count() / 1e6, e.cpu.count() / 1e6, e.calls, e.name);
+        }
+    }
+    return fmt::to_string(out);
+}
+
+CLICE_INLINE void printProfile() {
+    auto format = Profile::getInstance().format;
+    if (format == ProfileFormat::None) return;
+    endProfileEntry(); // the callback called exit()
+    auto text = renderProfile(format);
+    auto file = stderr;
+    if (auto path = std::getenv("CLICE_PROFILE_FILE"); path and *path) {
+        file = std::fopen(path, "w");
+        if (!file) {
+            fmt::print(stderr, "clice: can't write profile to {}\n", path);
+            return;
+        }
+    }
+    std::fwrite(text.data(), 1, text.size(), file);
+    if (file != stderr) std::fclose(file);
+}
+#endif
+
+}
@@ -0,0 +1,116 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+#include "config.h"
+#include "configFile.h"
+
+#include <filesystem>
+#include <mutex>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace clice {
+
+/**
+ * Reloading of arguments with a clice::Reloadable value while the program runs
+ *
+ *   clice::reload("--level 3 --rate-limit 100");  // command string, subcommands as on the command line
+ *   clice::reloadConfig("/etc/tool.ini");         // config file (see configFile.h)
+ *
+ * Values are converted like on the command line and published with Reloadable::store, which
+ * notifies its observers. Naming an argument that isn't reloadable in a command string throws,
+ * a config file reload skips those keys (they only apply at startup). Values before an invalid
+ * one are applied. Calls of reload and reloadConfig are serialized.
+ */
+CLICE_INLINE auto reloadMutex() -> std::mutex&;
+CLICE_INLINE void reloadValue(ArgumentBase& arg, std::string_view value);
+CLICE_INLINE void reload(std::span<std::string_view const> args);
+CLICE_INLINE void reload(std::string_view commandString);
+CLICE_INLINE auto reloadConfig(std::filesystem::path const& path) -> size_t;
+
+#if CLICE_DEFINITIONS
+CLICE_INLINE auto reloadMutex() -> std::mutex& {
+    static std::mutex mutex;
+    return mutex;
+}
+
+// only the value changes: isSet and the callbacks stay as clice::parse left them
+CLICE_INLINE void reloadValue(ArgumentBase& arg, std::string_view value) {
+    arg.storeValue(value);
+}
+
+CLICE_INLINE void reload(std::span<std::string_view const> args) {
+    auto lock = std::lock_guard{reloadMutex()};
+
+    // searches the active command and its parents, like clice::parse
+    ArgumentBase* command{};
+    auto find = [&](std::string_view name) -> ArgumentBase* {
+        for (auto scope = command;; scope = scope->parent) {
+            auto const& list = scope?scope->children:Register::getInstance().arguments;
+            for (auto arg : list) {
+                if (std::ranges::find(arg->args, name) != arg->args.end()) return arg;
+            }
+            if (!scope) return nullptr;
+        }
+    };
+
+    for (size_t i{0}; i < args.size(); ++i) {
+        auto arg = find(args[i]);
+        if (!arg) {
+            throw std::runtime_error{"unknown argument \"" + std::string{args[i]} + "\""};
+        }
+        if (!arg->storeValue) {
+            arg->expandChildren();
+            if (!arg->children.empty()) {
+                command = arg;
+                continue;
+            }
+            throw std::runtime_error{"argument \"" + std::string{args[i]} + "\" is not reloadable"};
+        }
+        if (i+1 == args.size()) {
+            throw std::runtime_error{"argument \"" + std::string{args[i]} + "\" is missing a value"};
+        }
+        reloadValue(*arg, args[++i]);
+    }
+}
+
+// splits at whitespace, "..." groups words
+CLICE_INLINE void reload(std::string_view commandString) {
+    auto args = std::vector<std::string_view>{};
+    while (true) {
+        auto first = commandString.find_first_not_of(" \t\r\n");
+        if (first == std::string_view::npos) break;
+        commandString.remove_prefix(first);
+        if (commandString[0] == '"') {
+            auto close = commandString.find('"', 1);
+            if (close == std::string_view::npos) {
+                throw std::runtime_error{"missing '\"' in reload command"};
+            }
+            args.push_back(commandString.substr(1, close-1));
+            commandString.remove_prefix(close+1);
+        } else {
+            auto end = commandString.find_first_of(" \t\r\n");
+            args.push_back(commandString.substr(0, end));
+            commandString.remove_prefix(end == std::string_view::npos?commandString.size():end);
+        }
+    }
+    reload(args);
+}
+
+CLICE_INLINE auto reloadConfig(std::filesystem::path const& path) -> size_t {
+    auto lock = std::lock_guard{reloadMutex()};
+    auto file = MappedFile{path};
+    return visitConfig(file.text, path.string(), [](ArgumentBase& arg, std::string_view value) {
+        if (!arg.storeValue) return false;
+        reloadValue(arg, value);
+        return true;
+    });
+}
+#endif
+
+}
@@ -0,0 +1,100 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "typeDescriptor.h"
+
+#include <atomic>
+#include <concepts>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+namespace clice {
+
+/**
+ * Value of an option that can be changed while the program runs (see reload.h)
+ *
+ *   auto cliLevel = clice::Argument{ .args = "--level", .value = clice::Reloadable{2} };
+ *   ...
+ *   auto level = cliLevel->load(); // on any thread
+ *
+ * The current value lives in an atomic shared pointer. load() copies it, snapshot() shares it
+ * without a copy. store() publishes a new value and notifies the observers. A replaced value is
+ * freed when the last snapshot referring to it is released.
+ */
+template <typename T>
+struct Reloadable {
+    static_assert(!HasPushBack<T> or std::same_as<std::string, T>, "lists can't be reloadable");
+    using value_type = T;
+
+    Reloadable() : Reloadable{T{}} {}
+    Reloadable(T value)
+        : current{std::make_shared<T const>(std::move(value))}
+    {}
+    // copies the current value, needed for .mapping
+    Reloadable(Reloadable const& other) : Reloadable{other.load()} {}
+    auto operator=(Reloadable const&) -> Reloadable& = delete;
+
+    auto load() const -> T {
+        return *snapshot();
+    }
+
+    // the current value, stays valid while the pointer is held
+    auto snapshot() const -> std::shared_ptr<T const> {
+        return current.load(std::memory_order_acquire);
+    }
+
+    auto operator*() const -> T {
+        return load();
+    }
+
+    auto operator->() const -> std::shared_ptr<T const> {
+        return snapshot();
+    }
+
+    // observers are called on the thread calling store, if the value changed
+    void store(T value) {
+        auto notify = std::vector<std::function<void(T const&)>>{};
+        auto next   = std::shared_ptr<T const>{};
+        {
+            auto lock = std::lock_guard{mutex};
+            if constexpr (std::equality_comparable<T>) {
+                if (value == *snapshot()) return;
+            }
+            next   = std::make_shared<T const>(std::move(value));
+            current.store(next, std::memory_order_release);
+            notify = observers;
+        }
+        for (auto const& observer : notify) {
+            observer(*next);
+        }
+    }
+
+    // const, so it can be called through the Argument (cliLevel->observe(...))
+    void observe(std::function<void(T const&)> observer) const {
+        auto lock = std::lock_guard{mutex};
+        observers.push_back(std::move(observer));
+    }
+
+private:
+    std::atomic<std::shared_ptr<T const>>              current;
+    mutable std::mutex                                 mutex; // store() and observe()
+    mutable std::vector<std::function<void(T const&)>> observers;
+};
+
+template <typename T>
+constexpr bool IsReloadable = false;
+
+template <typename T>
+constexpr bool IsReloadable<Reloadable<T>> = true;
+
+template <typename T>
+struct TypeTraits<Reloadable<T>> {
+    static constexpr auto descriptor = TypeTraits<T>::descriptor;
+};
+
+}
@@ -0,0 +1,261 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+#include "config.h"
+#include "parseString.h"
+#include "triggers.h"
+
+#include <algorithm>
+#include <bit>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iterator>
+#include <memory_resource>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <tuple>
+#include <vector>
+
+#ifndef _WIN32
+    #include <cerrno>
+    #include <unistd.h>
+#endif
+
+namespace clice {
+
+/**
+ * Snapshot of the parsed state
+ *
+ * saveSnapshot() stores which arguments are set (including the active subcommands) and their
+ * converted values in a compact binary blob. restoreSnapshot(blob) sets them again and runs the
+ * callbacks like clice::parse (see runTriggers), without reading argv or converting values.
+ *
+ * For supervisors restarting workers with the same command line: clice::parse restores the blob
+ * from CLICE_SNAPSHOT (base64, see encodeSnapshot) or reads it from the file descriptor
+ * CLICE_SNAPSHOT_FD instead of parsing argv and environment variables.
+ *
+ * Values are copied as in memory, so a blob is only valid for the same program on the same
+ * architecture. The header contains a hash of the argument tree (aliases, types, mappings, tags...),
+ * restoring a blob of a different tree throws.
+ *
+ *   "clsn" <u32 format version> <u64 schema hash> <u32 count> (<u32 argument index> <value>)...
+ */
+inline constexpr auto snapshotMagic   = std::string_view{"clsn"};
+inline constexpr auto snapshotVersion = uint32_t{1};
+
+CLICE_INLINE auto snapshotArguments() -> std::vector<ArgumentBase*>;
+CLICE_INLINE auto snapshotSchemaHash() -> uint64_t;
+CLICE_INLINE auto saveSnapshot() -> std::string;
+CLICE_INLINE void restoreSnapshot(std::string_view blob);
+CLICE_INLINE auto encodeSnapshot(std::string_view blob) -> std::string;
+CLICE_INLINE auto decodeSnapshot(std::string_view text) -> std::string;
+CLICE_INLINE auto restoreSnapshotFromEnv() -> bool;
+
+#if CLICE_DEFINITIONS
+// all arguments in the order of the argument tree, a snapshot refers to them by index
+CLICE_INLINE auto snapshotArguments() -> std::vector<ArgumentBase*> {
+    auto result = std::vector<ArgumentBase*>{};
+    auto visit = [&](auto const& self, ArgumentList const& args) -> void {
+        for (auto arg : args) {
+            result.push_back(arg);
+            arg->expandChildren();
+            self(self, arg->children);
+        }
+    };
+    visit(visit, Register::getInstance().arguments);
+    return result;
+}
+
+// FNV-1a of everything that decides how the values of a snapshot are interpreted
+CLICE_INLINE auto snapshotSchemaHash() -> uint64_t {
+    auto hash = uint64_t{14695981039346656037ull};
+    auto add = [&](std::string_view str) {
+        for (auto c : str) {
+            hash = (hash ^ static_cast<unsigned char>(c)) * 1099511628211ull;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ull; // separator
+    };
+    add(std::endian::native == std::endian::little?"little":"big");
+    add(std::to_string(sizeof(void*)));
+    auto visit = [&](auto const& self, ArgumentList const& args) -> void {
+        add("{");
+        for (auto arg : args) {
+            for (auto const& a : arg->args) add(a);
+            add(arg->id);
+            add(arg->type_index.name());
+            add(arg->type->name);
+            add(std::to_string(static_cast<int>(arg->type->kind)));
+            add(std::to_string(static_cast<int>(arg->type->element)));
+            if (arg->mapping) {
+                for (auto const& m : *arg->mapping) add(m);
+            }
+            auto tags = std::vector<std::string_view>{arg->tags.begin(), arg->tags.end()};
+            std::ranges::sort(tags);
+            for (auto t : tags) add(t);
+            arg->expandChildren();
+            self(self, arg->children);
+        }
+        add("}");
+    };
+    visit(visit, Register::getInstance().arguments);
+    return hash;
+}
+
+CLICE_INLINE auto saveSnapshot() -> std::string {
+    auto out = std::string{snapshotMagic};
+    writeBinaryValue(out, snapshotVersion);
+    writeBinaryValue(out, snapshotSchemaHash());
+    auto countPos = out.size();
+    auto count    = uint32_t{};
+    writeBinaryValue(out, count);
+
+    auto args = snapshotArguments();
+    for (size_t i{0}; i < args.size(); ++i) {
+        auto arg = args[i];
+        if (!arg->isSet) continue;
+        writeBinaryValue(out, static_cast<uint32_t>(i));
+        if (arg->saveValue) {
+            arg->saveValue(out);
+        } else if (arg->type->kind != TypeKind::Flag) {
+            auto name = arg->args.empty()?arg->id:arg->args[0];
+            throw std::runtime_error{"the value of \"" + name + "\" can't be stored in a snapshot"};
+        }
+        ++count;
+    }
+    std::memcpy(out.data() + countPos, &count, sizeof(count));
+    return out;
+}
+
+CLICE_INLINE void restoreSnapshot(std::string_view blob) {
+    if (!blob.starts_with(snapshotMagic)) {
+        throw std::runtime_error{"not a clice snapshot"};
+    }
+    blob.remove_prefix(snapshotMagic.size());
+    auto version = uint32_t{};
+    auto hash    = uint64_t{};
+    readBinaryValue(blob, version);
+    readBinaryValue(blob, hash);
+    if (version != snapshotVersion or hash != snapshotSchemaHash()) {
+        throw std::runtime_error{"snapshot was created for different arguments (schema version mismatch)"};
+    }
+
+    auto args  = snapshotArguments();
+    auto count = uint32_t{};
+    readBinaryValue(blob, count);
+    for (uint32_t i{0}; i < count; ++i) {
+        auto index = uint32_t{};
+        readBinaryValue(blob, index);
+        if (index >= args.size()) {
+            throw std::runtime_error{"snapshot refers to an unknown argument"};
+        }
+        auto arg = args[index];
+        if (arg->init) arg->init();
+        if (arg->loadValue) arg->loadValue(blob);
+        if (!arg->tags.contains("multi")) arg->fromString = nullptr; // has its value, like after clice::parse
+    }
+    if (!blob.empty()) {
+        throw std::runtime_error{"snapshot has trailing data"};
+    }
+
+    // same sequence as clice::parse, the set arguments are the active ones
+    auto active = std::vector<ArgumentBase*>{};
+    std::ranges::copy_if(args, std::back_inserter(active), &ArgumentBase::isSet);
+    runTriggers(active, [](ArgumentBase const* arg) { arg->cb(); }, {}, std::pmr::get_default_resource());
+}
+
+CLICE_INLINE auto encodeSnapshot(std::string_view blob) -> std::string {
+    constexpr auto chars = std::string_view{"ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/"};
+    auto out = std::string{};
+    out.reserve((blob.size() + 2) / 3 * 4);
+    for (size_t i{0}; i < blob.size(); i += 3) {
+        auto n = std::min<size_t>(3, blob.size() - i);
+        auto v = uint32_t{};
+        for (size_t j{0}; j < 3; ++j) {
+            v = (v << 8) | (j < n?static_cast<unsigned char>(blob[i+j]):0u);
+        }
+        for (size_t j{0}; j < 4; ++j) {
+            out.push_back(j <= n?chars[(v >> (18 - 6*j)) & 0x3f]:'=');
+        }
+    }
+    return out;
+}
+
+CLICE_INLINE auto decodeSnapshot(std::string_view text) -> std::string {
+    auto decode = [](char c) -> uint32_t {
+        if (c >= 'A' and c <= 'Z') return c - 'A';
+        if (c >= 'a' and c <= 'z') return c - 'a' + 26;
+        if (c >= '0' and c <= '9') return c - '0' + 52;
+        if (c == '+') return 62;
+        if (c == '/') return 63;
+        throw std::runtime_error{"snapshot is not base64 encoded"};
+    };
+    if (text.size() % 4 != 0) {
+        throw std::runtime_error{"snapshot is not base64 encoded"};
+    }
+    auto out = std::string{};
+    out.reserve(text.size() / 4 * 3);
+    for (size_t i{0}; i < text.size(); i += 4) {
+        auto v       = uint32_t{};
+        auto padding = size_t{};
+        for (size_t j{0}; j < 4; ++j) {
+            auto c = text[i+j];
+            if (c == '=' and i + 4 == text.size() and j >= 2) {
+                ++padding;
+                v <<= 6;
+            } else if (padding > 0) {
+                throw std::runtime_error{"snapshot is not base64 encoded"};
+            } else {
+                v = (v << 6) | decode(c);
+            }
+        }
+        for (size_t j{0}; j < 3 - padding; ++j) {
+            out.push_back(static_cast<char>((v >> (16 - 8*j)) & 0xff));
+        }
+    }
+    return out;
+}
+
+/**
+ * Restores the snapshot given by CLICE_SNAPSHOT or CLICE_SNAPSHOT_FD
+ * Both variables are removed, so they are not inherited by child processes.
+ * returns false if neither is set
+ */
+CLICE_INLINE auto restoreSnapshotFromEnv() -> bool {
+    auto blob = std::string{};
+    if (auto ptr = std::getenv("CLICE_SNAPSHOT"); ptr) {
+        blob = decodeSnapshot(ptr);
+#ifndef _WIN32
+    } else if (auto ptr = std::getenv("CLICE_SNAPSHOT_FD"); ptr) {
+        auto fd = parseFromString<int>(ptr);
+        ::lseek(fd, 0, SEEK_SET); // a file written by the supervisor, fails harmlessly for pipes
+        char buffer[4096];
+        for (;;) {
+            auto n = ::read(fd, buffer, sizeof(buffer));
+            if (n < 0 and errno == EINTR) continue;
+            if (n < 0) {
+                throw std::runtime_error{"can't read snapshot from file descriptor " + std::string{ptr}};
+            }
+            if (n == 0) break;
+            blob.append(buffer, static_cast<size_t>(n));
+        }
+        ::close(fd);
+#endif
+    } else {
+        return false;
+    }
+#ifdef _WIN32
+    _putenv_s("CLICE_SNAPSHOT", "");
+#else
+    unsetenv("CLICE_SNAPSHOT");
+    unsetenv("CLICE_SNAPSHOT_FD");
+#endif
+    restoreSnapshot(blob);
+    return true;
+}
+#endif
+
+}
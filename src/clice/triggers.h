@@ -0,0 +1,123 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include "Argument.h"
+#include "config.h"
+
+#include <algorithm>
+#include <functional>
+#include <memory_resource>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace clice {
+
+CLICE_INLINE auto createParameterStrList(std::vector<std::string> const& args) -> std::string;
+CLICE_INLINE void runTriggers(std::span<ArgumentBase* const> activeBases,
+                              std::function<void(ArgumentBase const*)> const& run,
+                              std::function<void()> const& validated,
+                              std::pmr::memory_resource* resource);
+
+#if CLICE_DEFINITIONS
+// creates a string like "-i, --input"
+CLICE_INLINE auto createParameterStrList(std::vector<std::string> const& args) -> std::string {
+    auto param = std::string{};
+    for (auto const& a : args) {
+        param += a + ", ";
+    }
+    if (param.size() > 1) {
+        param.pop_back();
+        param.pop_back();
+    }
+    return param;
+}
+
+/**
+ * Runs the callbacks once all values are set (clice::parse, restoreSnapshot)
+ *
+ *  1. callbacks of arguments tagged "ignore-required" (e.g. --help), so they run even if validation fails
+ *  2. checks that the active arguments got their values and their required children, and the required root arguments
+ *  3. all other callbacks
+ *
+ * Callbacks run by priority, same priorities keep the order of the argument tree.
+ * activeBases: the selected arguments, in the order they were given
+ * run: calls arg->cb(), clice::parse wraps it with its instrumentation
+ * validated: called after 2.
+ * resource: memory of the trigger list
+ */
+CLICE_INLINE void runTriggers(std::span<ArgumentBase* const> activeBases,
+                              std::function<void(ArgumentBase const*)> const& run,
+                              std::function<void()> const& validated,
+                              std::pmr::memory_resource* resource) {
+    auto triggers = std::pmr::vector<std::tuple<size_t, size_t, ArgumentBase*>>{resource}; // priority, order, argument
+    auto collectTriggers = [&](auto const& self, ArgumentList const& args) -> void {
+        for (auto arg : args) {
+            if (arg->cb) {
+                triggers.emplace_back(arg->cb_priority, triggers.size(), arg);
+            }
+            self(self, arg->children);
+        }
+    };
+    collectTriggers(collectTriggers, Register::getInstance().arguments);
+    std::ranges::sort(triggers);
+
+    // trigger all calls that have a "ignore-required" tag
+    {
+        bool only_ignore = true;
+        for (auto const& [level, order, arg] : triggers) {
+            if (!only_ignore && arg->tags.contains("ignore-required")) {
+                throw std::runtime_error{"option " + arg->id + " could not run, since a higher priority option is missing a \"ignore-required\" tag"};
+            }
+            if (!arg->tags.contains("ignore-required")) {
+                // do not execute any further callback
+                only_ignore = false;
+            }
+            if (only_ignore) {
+                run(arg);
+            }
+        }
+    }
+
+    // check if all active arguments got parameters
+    for (size_t j{0}; j < activeBases.size(); ++j) {
+        auto const& base = activeBases[activeBases.size()-j-1];
+        if (!base->tags.contains("multi") && base->fromString) {
+            auto param = createParameterStrList(base->args);
+            throw std::runtime_error{"option " + base->id + "\"" + param + "\" is missing a value (2)"};
+        }
+        for (auto child : base->children) {
+            if (child->tags.contains("required")) {
+                if (std::ranges::find(activeBases, child) == activeBases.end()) {
+                    auto option = createParameterStrList(base->args);
+                    auto suboption = createParameterStrList(child->args);
+                    throw std::runtime_error{"option " + child->id + "\"" + suboption + "\" is required (enforced by \"" + option + "\")"};
+                }
+            }
+        }
+    }
+
+    // check if all top level arguments got parameters
+    for (auto base : Register::getInstance().arguments) {
+        if (base->tags.contains("required")) {
+            if (std::ranges::find(activeBases, base) == activeBases.end()) {
+                auto option = createParameterStrList(base->args);
+                throw std::runtime_error{"option " + base->id + " \"" + option + "\" is a required parameter"};
+            }
+        }
+    }
+    if (validated) validated();
+
+    // call triggers in priority level order
+    for (auto const& [level, order, arg] : triggers) {
+        if (!arg->tags.contains("ignore-required")) {
+            run(arg);
+        }
+    }
+}
+#endif
+
+}
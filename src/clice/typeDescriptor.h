@@ -0,0 +1,114 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+#pragma once
+
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+namespace clice {
+
+template <typename S>
+constexpr bool HasPushBack = requires {
+    typename S::value_type;
+    { std::declval<S>().push_back(std::declval<typename S::value_type>()) };
+};
+
+enum class TypeKind {
+    Flag,  // takes no value
+    Value, // takes a single value
+    List,  // takes multiple values
+};
+
+enum class ElementKind {
+    None, // flags
+    Bool,
+    Char,
+    Int,
+    Float,
+    String,
+    Path,
+    Enum,
+    Unknown,
+};
+
+enum class CompletionHint {
+    None,
+    Files,
+};
+
+/**
+ * Description of a value type, computed at compile time
+ *
+ * Used by help, CWL and completion instead of comparing std::type_index values.
+ */
+struct TypeDescriptor {
+    TypeKind         kind{TypeKind::Value};
+    ElementKind      element{ElementKind::Unknown};
+    std::string_view name{};    // help page name of a single value, e.g. "INT32", empty if unknown
+    std::string_view cwlType{}; // "boolean", "int", "double" or "string", empty if not representable
+    CompletionHint   completion{CompletionHint::None};
+};
+
+/**
+ * TypeTraits<T>::descriptor describes T
+ *
+ * User defined value types can provide their own descriptor:
+ *
+ *   template <>
+ *   struct clice::TypeTraits<MyType> {
+ *       static constexpr auto descriptor = clice::TypeDescriptor {
+ *           .element = clice::ElementKind::String,
+ *           .name    = "MYTYPE",
+ *           .cwlType = "string",
+ *       };
+ *   };
+ *
+ * Lists take the element kind, name, cwlType and completion of their value_type.
+ */
+template <typename T>
+struct TypeTraits {
+    static constexpr auto descriptor = []() -> TypeDescriptor {
+        if constexpr (std::same_as<std::nullptr_t, T>) {
+            return {.kind = TypeKind::Flag, .element = ElementKind::None, .cwlType = "boolean"};
+        } else if constexpr (std::same_as<bool, T>) {
+            return {.element = ElementKind::Bool, .name = "[true|false]", .cwlType = "boolean"};
+        } else if constexpr (std::same_as<char, T>) {
+            return {.element = ElementKind::Char, .name = "CHAR"};
+        } else if constexpr (std::integral<T>) {
+            constexpr auto names = std::is_signed_v<T>
+                ? std::array<std::string_view, 4>{"INT8", "INT16", "INT32", "INT64"}
+                : std::array<std::string_view, 4>{"UINT8", "UINT16", "UINT32", "UINT64"};
+            constexpr auto idx = sizeof(T) == 1?0:sizeof(T) == 2?1:sizeof(T) == 4?2:3;
+            return {.element = ElementKind::Int, .name = names[idx], .cwlType = "int"};
+        } else if constexpr (std::same_as<float, T>) {
+            return {.element = ElementKind::Float, .name = "FLOAT", .cwlType = "double"};
+        } else if constexpr (std::same_as<double, T>) {
+            return {.element = ElementKind::Float, .name = "DOUBLE", .cwlType = "double"};
+        } else if constexpr (std::same_as<std::string, T>) {
+            return {.element = ElementKind::String, .name = "STRING", .cwlType = "string"};
+        } else if constexpr (std::same_as<std::filesystem::path, T>) {
+            return {.element = ElementKind::Path, .name = "PATH", .cwlType = "string", .completion = CompletionHint::Files};
+        } else if constexpr (std::is_enum_v<T>) {
+            return {.element = ElementKind::Enum};
+        } else if constexpr (HasPushBack<T>) {
+            auto d = TypeTraits<typename T::value_type>::descriptor;
+            d.kind = TypeKind::List;
+            return d;
+        } else if constexpr (std::is_invocable_v<T>) {
+            // lazily evaluated default value, always parsed as a single value
+            auto d = TypeTraits<std::decay_t<std::invoke_result_t<T>>>::descriptor;
+            d.kind = TypeKind::Value;
+            return d;
+        } else {
+            return {};
+        }
+    }();
+};
+
+}
@@ -0,0 +1,17 @@
+// SPDX-FileCopyrightText: 2023 Gottlieb+Freitag <info@gottliebtfreitag.de>
+// SPDX-License-Identifier: ISC
+
+// compiled part of clice (CMake: -DCLICE_BUILD_LIB=ON), see clice/config.h
+#ifndef CLICE_BUILDING_LIB
+    #error "libclice must be compiled with CLICE_BUILDING_LIB defined"
+#endif
+
+#include <clice/clice.h>
+
+namespace clice {
+
+#define CLICE_INSTANTIATE_PARSE_FROM_STRING(T) template auto parseFromString<T>(std::string_view) -> T;
+CLICE_BUILTIN_VALUE_TYPES(CLICE_INSTANTIATE_PARSE_FROM_STRING)
+#undef CLICE_INSTANTIATE_PARSE_FROM_STRING
+
+}
@@ -0,0 +1,58 @@
+// SPDX-FileCopyrightText: 2025 Simon Gene Gottlieb
+// SPDX-License-Identifier: CC0-1.0
+#include "allocations.h" // bench/allocations.h, counts the calls to the global operator new
+
+#include <clice/clice.h>
+#include <catch2/catch_all.hpp>
+
+namespace {
+// number of allocations during clice::parse(argc, argv)
+auto parseAllocations(std::vector<char const*> argv) -> size_t {
+    auto before = allocationCount();
+    auto failed = clice::parse(static_cast<int>(argv.size()), argv.data());
+    auto count  = allocationCount() - before;
+    CHECK(!failed);
+    return count;
+}
+}
+
+TEST_CASE("check allocations of clice::parse", "allocations") {
+    auto calls      = int{};
+    auto cliFlag    = clice::Argument{ .args = {"-f", "--flag"} };
+    auto cliCb      = clice::Argument{ .args = "--cb", .cb = [&]() { ++calls; } };
+    auto cliInt     = clice::Argument{ .args = "--int", .value = int{} };
+    auto cliDouble  = clice::Argument{ .args = "--double", .value = double{} };
+    auto cliSize    = clice::Argument{ .args = "--size", .value = size_t{}, .suffix = "b" };
+    auto cliThreads = clice::Argument{ .args = "--threads", .env = "CLICE_TEST_ALLOC_THREADS", .value = size_t{1} };
+    auto cliCmd     = clice::Argument{ .args = "cmd" };
+    auto cliCmdOpt  = clice::Argument{ .parent = &cliCmd, .args = "--opt", .value = int64_t{} };
+    auto cliCmdFlag = clice::Argument{ .parent = &cliCmd, .args = "--sub-flag" };
+    clice::parseReportSink = nullptr;
+
+    SECTION("flags") {
+        CHECK(parseAllocations({"app", "--flag", "--cb"}) == 0);
+        CHECK(cliFlag);
+        CHECK(calls == 1);
+    }
+    SECTION("typed options") {
+        CHECK(parseAllocations({"app", "--int", "-42", "--double", "2.5k", "--size", "4Mib"}) == 0);
+        CHECK(*cliInt == -42);
+        CHECK(*cliDouble == 2500.);
+        CHECK(*cliSize == 4 * 1024 * 1024);
+    }
+    SECTION("subcommand with children") {
+        CHECK(parseAllocations({"app", "--flag", "cmd", "--opt", "1'000'000", "--sub-flag"}) == 0);
+        CHECK(*cliCmdOpt == 1'000'000);
+        CHECK(cliCmdFlag);
+    }
+    SECTION("environment variables") {
+        setenv("CLICE_TEST_ALLOC_THREADS", "8", 1);
+        CHECK(parseAllocations({"app"}) == 0);
+        unsetenv("CLICE_TEST_ALLOC_THREADS");
+        CHECK(*cliThreads == 8);
+    }
+    SECTION("string values allocate") {
+        auto cliString = clice::Argument{ .args = "--string", .value = std::string{} };
+        CHECK(parseAllocations({"app", "--string", "a string that doesn't fit into the small string buffer"}) > 0);
+    }
+}
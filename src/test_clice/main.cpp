@@ -5,6 +5,33 @@
 #include <clice/clice.h>
 #include <catch2/catch_all.hpp>
 
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace {
+// everything f writes to stdout
+template <typename F>
+auto captureStdout(F const& f) -> std::string {
+    std::fflush(stdout);
+    auto file  = std::tmpfile();
+    auto saved = dup(STDOUT_FILENO);
+    dup2(fileno(file), STDOUT_FILENO);
+    f();
+    std::fflush(stdout);
+    dup2(saved, STDOUT_FILENO);
+    close(saved);
+    std::rewind(file);
+    auto out = std::string{};
+    for (int c; (c = std::fgetc(file)) != EOF;) out += static_cast<char>(c);
+    std::fclose(file);
+    return out;
+}
+}
+
 template <typename T>
 concept dereferencable = requires(T t) {
     { *t };
@@ -268,3 +295,760 @@ TEST_CASE("check clice::Argument", "argument") {
 
 
 }
+
+TEST_CASE("check completion matching", "completion") {
+    SECTION("fuzzy score") {
+        CHECK(clice::fuzzyCompletionScore("--input", "xyz") == 0);
+        CHECK(clice::fuzzyCompletionScore("--input", "inp") > 0);
+        CHECK(clice::fuzzyCompletionScore("--input", "--in") > clice::fuzzyCompletionScore("--ints", "--ip"));
+        CHECK(clice::fuzzyCompletionScore("--input", "") > 0);
+    }
+    // output of clice::printCompletionMatches
+    auto matches = [](std::vector<std::string_view> candidates, std::string_view word) {
+        return captureStdout([&]() { clice::printCompletionMatches(std::move(candidates), word); });
+    };
+    SECTION("prefix filtering") {
+        CHECK(matches({"--zeta", "--alpha", "--beta", "--alp"}, "--al") == "--alp\n--alpha\n");
+        CHECK(matches({"--zeta", "--alpha"}, "--x") == "");
+        CHECK(matches({"--zeta", "--alpha"}, "") == "--alpha\n--zeta\n");
+    }
+    SECTION("sorted candidates") {
+        CHECK(matches({"a", "b1", "b2", "b2", "c"}, "b") == "b1\nb2\n");
+        CHECK(matches({"a", "b1", "b2", "c"}, "c") == "c\n");
+        CHECK(matches({"a", "b1", "b2", "c"}, "d") == "");
+    }
+    SECTION("limit") {
+        setenv("CLICE_COMPLETION_LIMIT", "2", 1);
+        CHECK(matches({"c1", "a", "c3", "c2"}, "c") == "c1\nc2\n");
+        CHECK(matches({"c1", "c2", "c3"}, "c") == "c1\nc2\n");
+        setenv("CLICE_COMPLETION_FUZZY", "", 1);
+        CHECK(matches({"--input", "--ints", "--other"}, "in") == "--input\n--ints\n");
+        unsetenv("CLICE_COMPLETION_FUZZY");
+        setenv("CLICE_COMPLETION_LIMIT", "many", 1); // ignored
+        CHECK(matches({"c1", "c2", "c3"}, "c") == "c1\nc2\nc3\n");
+        unsetenv("CLICE_COMPLETION_LIMIT");
+    }
+}
+
+TEST_CASE("check embedded help", "help") {
+    clice::argv0 = "app";
+    auto cliCmd  = clice::Argument{ .args = "cmd", .desc = "a command" };
+    auto cliFlag = clice::Argument{ .parent = &cliCmd, .args = "--flag", .desc = "a flag" };
+    auto cliOpt  = clice::Argument{ .args = "--opt", .desc = "an option", .value = int{7} };
+
+    auto pages = clice::embeddedHelpPages();
+    REQUIRE(pages.size() == 2);
+    auto embedded = std::vector<clice::EmbeddedHelp>{};
+    for (auto const& [command, text] : pages) {
+        embedded.push_back({command, text});
+    }
+    clice::registerEmbeddedHelp(embedded);
+
+    CHECK(clice::checkEmbeddedHelp());
+    CHECK(clice::substituteArgv0(*clice::findEmbeddedHelp(nullptr)) == clice::generateHelp());
+    CHECK(clice::substituteArgv0(*clice::findEmbeddedHelp(&cliCmd.storage.arg)) == clice::generateHelp(cliCmd.storage.arg));
+    CHECK(captureStdout([]() { clice::printHelp(nullptr); }) == clice::generateHelp());
+    CHECK(captureStdout([&]() { clice::printHelp(&cliCmd.storage.arg); }) == clice::generateHelp(cliCmd.storage.arg));
+
+    clice::embeddedHelp = {};
+}
+
+TEST_CASE("check type descriptor", "type") {
+    using clice::TypeKind;
+    using clice::ElementKind;
+
+    static_assert(clice::TypeTraits<std::nullptr_t>::descriptor.kind == TypeKind::Flag);
+    static_assert(clice::TypeTraits<int32_t>::descriptor.name == "INT32");
+    static_assert(clice::TypeTraits<uint8_t>::descriptor.name == "UINT8");
+    static_assert(clice::TypeTraits<std::string>::descriptor.kind == TypeKind::Value);
+    static_assert(clice::TypeTraits<std::vector<double>>::descriptor.kind == TypeKind::List);
+    static_assert(clice::TypeTraits<std::vector<double>>::descriptor.element == ElementKind::Float);
+    static_assert(clice::TypeTraits<std::filesystem::path>::descriptor.completion == clice::CompletionHint::Files);
+
+    auto cliInts  = clice::Argument{ .args = "--ints", .value = std::vector<int>{} };
+    auto cliBools = clice::Argument{ .args = "--bools", .value = std::vector<bool>{} };
+    auto cliLazy  = clice::Argument{ .args = "--lazy", .value = []() { return std::string{"x"}; } };
+    CHECK(clice::typeToString(cliInts.storage.arg) == "[INT32]...");
+    CHECK(clice::typeToString(cliBools.storage.arg) == "[true|false]...");
+    CHECK(clice::typeToString(cliLazy.storage.arg) == "STRING");
+    CHECK(cliInts.storage.arg.tags.contains("multi"));
+    CHECK(!cliLazy.storage.arg.tags.contains("multi"));
+}
+
+TEST_CASE("check schema export", "schema") {
+    clice::argv0 = "app";
+    auto cliCmd  = clice::Argument{ .args = "cmd", .desc = "a \"command\"" };
+    auto cliOpt  = clice::Argument{ .parent = &cliCmd, .args = "--opt", .env = "APP_OPT", .value = int{7} };
+    auto cliMode = clice::Argument{ .args = "--mode", .value = 1, .mapping = {{{"fast", 1}, {"slow", 2}}} };
+
+    auto schema = clice::generateSchema();
+    CHECK(schema.starts_with(R"({"clice-schema":1,"program":"app","arguments":[)"));
+    CHECK(schema.find(R"("desc":"a \"command\"")") != std::string::npos);
+    CHECK(schema.find(R"({"args":["--opt"],"id":"","desc":"","env":["APP_OPT"],"tags":[],"symlink":false,"kind":"value","element":"int","type":"INT32","cwlType":"int","default":"7","mapping":null,"completion":"none","children":[]})") != std::string::npos);
+    CHECK(schema.find(R"("default":"fast","mapping":["fast","slow"])") != std::string::npos);
+}
+
+TEST_CASE("check parse instrumentation", "instrumentation") {
+    auto calls   = int{};
+    auto cliFlag = clice::Argument{ .args = "--flag", .cb = [&]() { ++calls; } };
+    auto cliInt  = clice::Argument{ .args = "--int", .value = int{} };
+
+    auto reports = std::vector<clice::ParseReport>{};
+    clice::parseReportSink = [&](clice::ParseReport const& report) {
+        reports.push_back(report);
+    };
+    auto args = std::vector<std::string_view>{"app", "--flag", "--int", "5"};
+    CHECK(!clice::parse(args));
+    clice::parseReportSink = nullptr;
+
+    REQUIRE(reports.size() == 1);
+    auto const& report = reports[0];
+    CHECK(report.tokens == 3);
+    CHECK(report.conversions == 1);
+    CHECK(report.callbacks == 1);
+    REQUIRE(report.callbackTimes.size() == 1);
+    CHECK(std::get<0>(report.callbackTimes[0]) == &cliFlag.storage.arg);
+    CHECK(std::get<2>(report.callbackTimes[0]) >= std::chrono::nanoseconds{0});
+    CHECK(report.totalTime >= report.tokensTime + report.callbacksTime);
+    CHECK(calls == 1);
+    CHECK(*cliInt == 5);
+}
+
+TEST_CASE("check callback profile", "profile") {
+    auto cliSlow  = clice::Argument{ .args = {"-s", "--slow"}, .cb = []() {} };
+    auto cliOther = clice::Argument{ .args = "--other", .cb = []() {} };
+
+    // set directly instead of enableProfile, which would print the profile at exit
+    auto& profile = clice::Profile::getInstance();
+    profile.format = clice::ProfileFormat::Json;
+    auto args = std::vector<std::string_view>{"app", "--slow", "--other"};
+    CHECK(!clice::parse(args));
+    CHECK(!clice::parse(args));
+    clice::recordProfile("<run>", std::chrono::seconds{1}, std::chrono::milliseconds{500});
+    profile.format = clice::ProfileFormat::None;
+
+    REQUIRE(profile.entries.size() == 3);
+    CHECK(profile.entries[0].name == "-s, --slow");
+    CHECK(profile.entries[0].calls == 2);
+    CHECK(profile.entries[1].name == "--other");
+    auto json = clice::renderProfile(clice::ProfileFormat::Json);
+    CHECK(json.starts_with(R"({"clice-profile":1,"entries":[{"name":"<run>","calls":1,"wall_ns":1000000000,"cpu_ns":500000000},)"));
+    auto text = clice::renderProfile(clice::ProfileFormat::Text);
+    CHECK(text.find("1000.000      500.000      1  <run>\n") != std::string::npos);
+    profile.entries.clear();
+}
+
+TEST_CASE("check config files", "config") {
+    auto cliThreads = clice::Argument{ .args = "--threads", .env = "CLICE_TEST_CONFIG_THREADS", .value = size_t{1} };
+    auto cliName    = clice::Argument{ .args = {"-n", "--name"}, .value = std::string{} };
+    auto cliVerbose = clice::Argument{ .args = "--verbose" };
+    auto cliQuiet   = clice::Argument{ .args = "--quiet" };
+    auto cliInts    = clice::Argument{ .args = "--ints", .value = std::vector<int>{} };
+    auto cliCmd     = clice::Argument{ .args = "build" };
+    auto cliJobs    = clice::Argument{ .parent = &cliCmd, .args = "--jobs", .value = int{} };
+
+    auto text = std::string_view{
+        "# comment\n"
+        "; comment\n"
+        "threads = 4 # comment\n"
+        "  name = \"some # name\" # comment\r\n"
+        "--verbose = true\n"
+        "quiet = false\n"
+        "ints = 1\n"
+        "ints = 2\n"
+        "\n"
+        "[build]\n"
+        "jobs = 3\n"};
+
+    SECTION("values") {
+        CHECK(clice::applyConfig(text) == 7);
+        CHECK(*cliThreads == 4);
+        CHECK(*cliName == "some # name");
+        CHECK(cliVerbose);
+        CHECK(!cliQuiet);
+        CHECK(*cliInts == std::vector<int>{1, 2});
+        CHECK(!cliCmd);
+        CHECK(*cliJobs == 3);
+    }
+    SECTION("precedence CLI > env > config > default") {
+        CHECK(clice::applyConfig("threads = 4\nname = config\n") == 2);
+        setenv("CLICE_TEST_CONFIG_THREADS", "8", 1);
+        auto args = std::vector<std::string_view>{"app", "--name", "cli"};
+        CHECK(!clice::parse(args));
+        unsetenv("CLICE_TEST_CONFIG_THREADS");
+        CHECK(*cliThreads == 8);
+        CHECK(*cliName == "cli");
+    }
+    SECTION("lists of the CLI replace lists of the config") {
+        CHECK(clice::applyConfig("ints = 1\nints = 2\n") == 2);
+        auto args = std::vector<std::string_view>{"app", "--ints", "3"};
+        CHECK(!clice::parse(args));
+        CHECK(*cliInts == std::vector<int>{3});
+    }
+    SECTION("memory mapped file") {
+        auto path = std::filesystem::temp_directory_path() / "clice-test-config.ini";
+        {
+            auto ofs = std::ofstream{path};
+            ofs << text;
+        }
+        CHECK(clice::loadConfig(path) == 7);
+        std::filesystem::remove(path);
+        CHECK(*cliName == "some # name");
+        CHECK(*cliJobs == 3);
+    }
+    SECTION("errors") {
+        CHECK_THROWS_WITH(clice::applyConfig("threads = 4\nunknown = 1\n", "a.ini"), "a.ini:2: unknown key \"unknown\"");
+        CHECK_THROWS_WITH(clice::applyConfig("[nope]\n", "a.ini"), "a.ini:1: unknown command \"nope\"");
+        CHECK_THROWS_WITH(clice::applyConfig("threads\n", "a.ini"), "a.ini:1: expected \"key = value\"");
+        CHECK_THROWS_WITH(clice::applyConfig("name = \"a\" b\n", "a.ini"), "a.ini:1: unexpected characters after '\"'");
+        CHECK_THROWS(clice::applyConfig("threads = many\n"));
+        CHECK_THROWS(clice::loadConfig("/nonexistent/clice.ini"));
+    }
+}
+
+TEST_CASE("check snapshots", "snapshot") {
+    enum class Mode { Fast, Slow };
+    auto calls = std::vector<std::string>{};
+    auto blob  = std::string{};
+    // the same arguments in the supervisor and in the worker
+    auto withArguments = [&](auto f) {
+        auto cliFlag  = clice::Argument{ .args = "--flag", .cb = [&]() { calls.push_back("flag"); } };
+        auto cliInt   = clice::Argument{ .args = "--int", .value = int{}, .cb = [&](int v) { calls.push_back("int " + std::to_string(v)); }, .cb_priority = 10 };
+        auto cliMode  = clice::Argument{ .args = "--mode", .value = Mode::Fast, .mapping = {{{"fast", Mode::Fast}, {"slow", Mode::Slow}}} };
+        auto cliPaths = clice::Argument{ .args = "--paths", .value = std::vector<std::filesystem::path>{} };
+        auto cliLazy  = clice::Argument{ .args = "--lazy", .value = []() { return std::string{"default"}; } };
+        auto cliCmd   = clice::Argument{ .args = "cmd" };
+        auto cliName  = clice::Argument{ .parent = &cliCmd, .args = "--name", .value = std::string{} };
+        f(cliFlag, cliInt, cliMode, cliPaths, cliLazy, cliCmd, cliName);
+    };
+
+    withArguments([&](auto&, auto&, auto&, auto&, auto&, auto&, auto&) {
+        auto args = std::vector<std::string_view>{"app", "--flag", "--int", "5", "--mode", "slow", "--lazy", "given", "cmd", "--name", "worker", "--paths", "a", "b/c"};
+        CHECK(!clice::parse(args));
+        blob = clice::saveSnapshot();
+    });
+    CHECK(calls == std::vector<std::string>{"int 5", "flag"});
+    calls.clear();
+
+    SECTION("restore") {
+        withArguments([&](auto& cliFlag, auto& cliInt, auto& cliMode, auto& cliPaths, auto& cliLazy, auto& cliCmd, auto& cliName) {
+            clice::restoreSnapshot(blob);
+            CHECK(cliFlag);
+            CHECK(*cliInt == 5);
+            CHECK(*cliMode == Mode::Slow);
+            CHECK(*cliPaths == std::vector<std::filesystem::path>{"a", "b/c"});
+            CHECK(*cliLazy == "given");
+            CHECK(cliCmd);
+            CHECK(*cliName == "worker");
+            CHECK(calls == std::vector<std::string>{"int 5", "flag"});
+        });
+    }
+    SECTION("restore through clice::parse and CLICE_SNAPSHOT") {
+        setenv("CLICE_SNAPSHOT", clice::encodeSnapshot(blob).c_str(), 1);
+        withArguments([&](auto&, auto& cliInt, auto&, auto&, auto&, auto&, auto& cliName) {
+            auto args = std::vector<std::string_view>{"app", "--unknown"};
+            CHECK(!clice::parse(args));
+            CHECK(*cliInt == 5);
+            CHECK(*cliName == "worker");
+        });
+        CHECK(std::getenv("CLICE_SNAPSHOT") == nullptr);
+    }
+    SECTION("restore through clice::parse and CLICE_SNAPSHOT_FD") {
+        int fds[2];
+        REQUIRE(pipe(fds) == 0);
+        REQUIRE(write(fds[1], blob.data(), blob.size()) == static_cast<ssize_t>(blob.size()));
+        close(fds[1]);
+        setenv("CLICE_SNAPSHOT_FD", std::to_string(fds[0]).c_str(), 1);
+        withArguments([&](auto&, auto&, auto& cliMode, auto&, auto&, auto&, auto&) {
+            auto args = std::vector<std::string_view>{"app"};
+            CHECK(!clice::parse(args));
+            CHECK(*cliMode == Mode::Slow);
+        });
+        CHECK(std::getenv("CLICE_SNAPSHOT_FD") == nullptr);
+    }
+    SECTION("base64") {
+        for (auto str : {"", "a", "ab", "abc", "abcd", "\x00\xff\x10"}) {
+            CHECK(clice::decodeSnapshot(clice::encodeSnapshot(str)) == str);
+        }
+        CHECK(clice::encodeSnapshot("ab") == "YWI=");
+        CHECK_THROWS(clice::decodeSnapshot("YW=I"));
+    }
+    SECTION("reject other schema versions") {
+        auto cliOther = clice::Argument{ .args = "--other" };
+        withArguments([&](auto&, auto&, auto&, auto&, auto&, auto&, auto&) {
+            CHECK_THROWS_WITH(clice::restoreSnapshot(blob), "snapshot was created for different arguments (schema version mismatch)");
+        });
+    }
+    SECTION("same callback sequence and validation as clice::parse") {
+        auto withRequired = [&](auto f) {
+            auto cliHelp = clice::Argument{ .args = "--help", .cb = [&]() { calls.push_back("help"); }, .cb_priority = 5, .tags = {"ignore-required"} };
+            auto cliReq  = clice::Argument{ .args = "--req", .value = int{}, .cb = [&](int) { calls.push_back("req"); }, .tags = {"required"} };
+            f();
+        };
+        withRequired([&]() {
+            auto args = std::vector<std::string_view>{"app", "--help"};
+            CHECK_THROWS_WITH(clice::parse(args), "option  \"--req\" is a required parameter");
+            blob = clice::saveSnapshot();
+        });
+        CHECK(calls == std::vector<std::string>{"help"});
+        calls.clear();
+        withRequired([&]() {
+            CHECK_THROWS_WITH(clice::restoreSnapshot(blob), "option  \"--req\" is a required parameter");
+        });
+        CHECK(calls == std::vector<std::string>{"help"});
+    }
+    SECTION("reject truncated snapshots") {
+        withArguments([&](auto&, auto&, auto&, auto&, auto&, auto&, auto&) {
+            CHECK_THROWS(clice::restoreSnapshot(std::string_view{blob}.substr(0, blob.size() - 1)));
+            CHECK_THROWS_WITH(clice::restoreSnapshot("garbage"), "not a clice snapshot");
+        });
+    }
+}
+
+TEST_CASE("check reloadable arguments", "reload") {
+    enum class Level { Low, High };
+    auto cliLevel = clice::Argument{ .args = "--level", .value = clice::Reloadable{Level::Low}, .mapping = {{{"low", Level::Low}, {"high", Level::High}}} };
+    auto cliRate  = clice::Argument{ .args = "--rate", .value = clice::Reloadable{size_t{10}}, .suffix = "/s" };
+    auto cliName  = clice::Argument{ .args = "--name", .value = std::string{} };
+    auto cliCmd   = clice::Argument{ .args = "cmd" };
+    auto cliJobs  = clice::Argument{ .parent = &cliCmd, .args = "--jobs", .value = clice::Reloadable{1}, .cb = []() {} };
+
+    auto args = std::vector<std::string_view>{"app", "--level", "high", "--rate", "20/s"};
+    CHECK(!clice::parse(args));
+    CHECK(cliLevel->load() == Level::High);
+    CHECK(cliRate->load() == 20);
+    CHECK(cliJobs->load() == 1);
+    CHECK(cliRate.storage.arg.toString() == "20");
+    CHECK(cliLevel.storage.arg.toString() == "high");
+
+    auto changes = std::vector<size_t>{};
+    cliRate->observe([&](size_t v) { changes.push_back(v); });
+
+    SECTION("command string") {
+        clice::reload("--rate 30/s --level low cmd --jobs 4");
+        CHECK(cliRate->load() == 30);
+        CHECK(cliLevel->load() == Level::Low);
+        CHECK(cliJobs->load() == 4);
+        // only the values change, not the parsed state
+        CHECK(!cliCmd);
+        CHECK(!cliJobs);
+        CHECK(!cliJobs.storage.arg.cb);
+        clice::reload("--rate 30/s");
+        CHECK(changes == std::vector<size_t>{30}); // unchanged values don't notify
+        CHECK_THROWS_WITH(clice::reload("--name x"), "argument \"--name\" is not reloadable");
+        CHECK_THROWS_WITH(clice::reload("--jobs 2"), "unknown argument \"--jobs\"");
+        CHECK_THROWS_WITH(clice::reload("--rate"), "argument \"--rate\" is missing a value");
+        CHECK_THROWS(clice::reload("--level medium"));
+        CHECK(cliLevel->load() == Level::Low);
+    }
+    SECTION("config file") {
+        auto path = std::filesystem::temp_directory_path() / "clice-test-reload.ini";
+        {
+            auto ofs = std::ofstream{path};
+            ofs << "name = ignored\nrate = 50/s\n[cmd]\njobs = 8\n";
+        }
+        CHECK(clice::reloadConfig(path) == 2);
+        std::filesystem::remove(path);
+        CHECK(*cliName == "");
+        CHECK(cliRate->load() == 50);
+        CHECK(cliJobs->load() == 8);
+        CHECK(changes == std::vector<size_t>{50});
+    }
+    SECTION("snapshots keep replaced values alive") {
+        auto value    = clice::Reloadable{std::string{"first"}};
+        auto snapshot = value.snapshot();
+        auto weak     = std::weak_ptr{snapshot};
+        value.store("second");
+        CHECK(*snapshot == "first");
+        CHECK(value.load() == "second");
+        CHECK(value->size() == 6);
+        snapshot.reset();
+        CHECK(weak.expired()); // freed with the last snapshot
+    }
+    SECTION("readers on other threads") {
+        auto done       = std::atomic<bool>{false};
+        auto decreasing = false; // values are only increased below
+        auto reader = std::thread{[&]() {
+            auto last = size_t{0};
+            while (!done) {
+                auto v = cliRate->load();
+                decreasing = decreasing or v < last;
+                last = v;
+            }
+        }};
+        for (size_t i{21}; i <= 200; ++i) {
+            clice::reload(std::vector<std::string_view>{"--rate", std::to_string(i) + "/s"});
+        }
+        done = true;
+        reader.join();
+        CHECK(!decreasing);
+        CHECK(cliRate->load() == 200);
+        CHECK(changes.size() == 180);
+    }
+}
+
+TEST_CASE("check lazy values", "lazy") {
+    auto evaluations = std::atomic<int>{};
+    auto cliLazy = clice::Argument{ .args = "--lazy", .value = [&]() { ++evaluations; return 42; } };
+
+    SECTION("evaluated once by concurrent readers") {
+        auto threads = std::vector<std::thread>{};
+        auto sum     = std::atomic<int>{};
+        for (int i{0}; i < 8; ++i) {
+            threads.emplace_back([&]() {
+                for (int j{0}; j < 100; ++j) {
+                    sum += *cliLazy;
+                }
+            });
+        }
+        for (auto& t : threads) t.join();
+        CHECK(evaluations == 1);
+        CHECK(sum == 8 * 100 * 42);
+    }
+    SECTION("given on the command line") {
+        auto args = std::vector<std::string_view>{"app", "--lazy", "7"};
+        CHECK(!clice::parse(args));
+        CHECK(*cliLazy == 7);
+        CHECK(evaluations == 0);
+    }
+}
+
+TEST_CASE("check prefetched values", "prefetch") {
+    auto evaluations = std::atomic<int>{};
+    auto mainThread  = std::this_thread::get_id();
+    auto evaluatedOn = std::thread::id{};
+    auto cliCores    = clice::Argument{ .args = "--cores", .value = [&]() { ++evaluations; evaluatedOn = std::this_thread::get_id(); return 8; }, .prefetch = true };
+    auto cliOther    = clice::Argument{ .args = "--other", .value = [&]() { ++evaluations; return 1; } };
+
+    SECTION("evaluated during parse") {
+        auto args = std::vector<std::string_view>{"app"};
+        CHECK(!clice::parse(args));
+        CHECK(evaluations == 1); // only the prefetched one, joined before parse returns
+        CHECK(evaluatedOn != mainThread);
+        CHECK(*cliCores == 8);
+        CHECK(*cliOther == 1);
+        CHECK(evaluations == 2);
+    }
+    SECTION("value given on the command line wins") {
+        auto args = std::vector<std::string_view>{"app", "--cores", "2"};
+        CHECK(!clice::parse(args));
+        CHECK(*cliCores == 2);
+        CHECK(evaluations <= 1);
+    }
+    SECTION("unregistered with the argument") {
+        auto cliLocal = clice::Argument{ .args = "--local", .value = []() { return 1; }, .prefetch = true };
+        CHECK(clice::Register::getInstance().prefetch.size() == 2);
+    }
+    CHECK(clice::Register::getInstance().prefetch.size() == 1);
+}
+
+TEST_CASE("check symlinked commands", "symlink") {
+    auto cliEnv     = clice::Argument{ .args = "env", .symlink = true };
+    auto cliEnvName = clice::Argument{ .parent = &cliEnv, .args = "--name", .value = std::string{} };
+    auto cliAddFile = clice::Argument{ .args = "add-file", .symlink = true };
+    auto cliOther   = clice::Argument{ .args = "other" };
+
+    CHECK(clice::findSymlink("/usr/bin/slix-env") == &cliEnv.storage.arg);
+    CHECK(clice::findSymlink("slix-add-file") == &cliAddFile.storage.arg);
+    CHECK(clice::findSymlink("my-tool-add-file") == &cliAddFile.storage.arg);
+    CHECK(clice::findSymlink("/usr/bin/slix-other") == nullptr);
+    CHECK(clice::findSymlink("/usr/bin-env/slix") == nullptr);
+    CHECK(clice::findSymlink("env") == nullptr);
+
+    SECTION("parse") {
+        auto args = std::vector<std::string_view>{"/usr/bin/slix-env", "--name", "x"};
+        CHECK(!clice::parse(args));
+        CHECK(cliEnv);
+        CHECK(*cliEnvName == "x");
+    }
+    SECTION("ambiguous registrations") {
+        CHECK_THROWS_WITH((clice::Argument{ .args = "file", .symlink = true }), "symlinked commands \"file\" and \"add-file\" are ambiguous");
+        CHECK_THROWS_WITH((clice::Argument{ .args = "x-env", .symlink = true }), "symlinked commands \"x-env\" and \"env\" are ambiguous");
+        CHECK(clice::Register::getInstance().symlinks.size() == 2);
+        auto cliFile = clice::Argument{ .args = "file" }; // not a symlink, no conflict
+    }
+    SECTION("unregistered with the argument") {
+        {
+            auto cliTmp = clice::Argument{ .args = "tmp", .symlink = true };
+            CHECK(clice::findSymlink("slix-tmp") == &cliTmp.storage.arg);
+        }
+        CHECK(clice::findSymlink("slix-tmp") == nullptr);
+    }
+}
+
+TEST_CASE("check lazy subcommands", "lazy") {
+    struct BuildArgs {
+        clice::Argument<>&   build;
+        clice::Argument<int> jobs{ .parent = &build, .args = "--jobs", .env = "CLICE_TEST_LAZY_JOBS", .value = 1 };
+        clice::Argument<>    release{ .parent = &build, .args = "--release" };
+        clice::Argument<>    debug{ .parent = &build, .args = "-d" };
+        clice::Argument<>    strip{ .parent = &build, .args = "-s" };
+    };
+    struct Tool {
+        int registered{};
+        clice::Argument<> cliBuild{ .args = "build", .desc = "builds the project", .lazyChildren = [this]() {
+            ++registered;
+            buildArgs = std::make_unique<BuildArgs>(cliBuild);
+        }};
+        clice::Argument<> cliTest{ .args = "test" };
+        std::unique_ptr<BuildArgs> buildArgs; // destroyed before cliBuild
+    } tool;
+
+    CHECK(tool.cliBuild.storage.arg.children.empty());
+
+    SECTION("registered when selected") {
+        setenv("CLICE_TEST_LAZY_JOBS", "3", 1);
+        auto args = std::vector<std::string_view>{"tool", "build", "--release"};
+        CHECK(!clice::parse(args));
+        unsetenv("CLICE_TEST_LAZY_JOBS");
+        CHECK(tool.registered == 1);
+        CHECK(*tool.buildArgs->jobs == 3);
+        CHECK(tool.buildArgs->release);
+    }
+    SECTION("command line overrides environment") {
+        setenv("CLICE_TEST_LAZY_JOBS", "3", 1);
+        auto args = std::vector<std::string_view>{"tool", "build", "--jobs", "5"};
+        CHECK(!clice::parse(args));
+        unsetenv("CLICE_TEST_LAZY_JOBS");
+        CHECK(*tool.buildArgs->jobs == 5);
+    }
+    SECTION("combined single dash options") {
+        auto args = std::vector<std::string_view>{"tool", "build", "-ds"};
+        CHECK(!clice::parse(args, /*.allowDashCombi=*/true));
+        CHECK(tool.buildArgs->debug);
+        CHECK(tool.buildArgs->strip);
+    }
+    SECTION("not registered for other commands") {
+        auto args = std::vector<std::string_view>{"tool", "test"};
+        CHECK(!clice::parse(args));
+        CHECK(tool.registered == 0);
+        CHECK(tool.cliBuild.storage.arg.children.empty());
+    }
+    SECTION("help") {
+        CHECK(clice::generateHelp().find("--jobs") != std::string::npos);
+        CHECK(clice::generateHelp(tool.cliBuild.storage.arg).find("--release") != std::string::npos);
+        CHECK(tool.registered == 1);
+    }
+    SECTION("config files") {
+        CHECK(clice::applyConfig("[build]\njobs = 7\n") == 1);
+        CHECK(*tool.buildArgs->jobs == 7);
+    }
+}
+
+TEST_CASE("check registration order", "register") {
+    auto cliCmd = clice::Argument{ .args = "cmd" };
+    auto names = [&]() {
+        auto result = std::vector<std::string>{};
+        for (auto arg : cliCmd.storage.arg.children) {
+            result.push_back(arg->args[0]);
+        }
+        return result;
+    };
+    auto cliA = clice::Argument{ .parent = &cliCmd, .args = "--a" };
+    auto cliB = std::unique_ptr<clice::Argument<>>(new clice::Argument<>{ .parent = &cliCmd, .args = "--b" });
+    auto cliC = std::unique_ptr<clice::Argument<>>(new clice::Argument<>{ .parent = &cliCmd, .args = "--c" });
+    CHECK(names() == std::vector<std::string>{"--a", "--b", "--c"});
+
+    cliB.reset();
+    CHECK(names() == std::vector<std::string>{"--a", "--c"});
+    CHECK(cliCmd.storage.arg.children.size() == 2);
+
+    auto cliD = clice::Argument{ .parent = &cliCmd, .args = "--d" };
+    CHECK(names() == std::vector<std::string>{"--a", "--c", "--d"});
+    cliC.reset();
+    CHECK(names() == std::vector<std::string>{"--a", "--d"});
+    CHECK(std::ranges::find(cliCmd.storage.arg.children, &cliD.storage.arg) != cliCmd.storage.arg.children.end());
+}
+
+TEST_CASE("check completion cache", "completion") {
+    using namespace std::chrono_literals;
+    auto dir = std::filesystem::temp_directory_path() / fmt::format("clice-test-cache-{}", getpid());
+    std::filesystem::remove_all(dir);
+    setenv("XDG_CACHE_HOME", dir.c_str(), 1);
+
+    // the refresh runs in a forked child, it sees generation and delay as they were at the time of the fork
+    auto generation = 1;
+    auto delay      = 0ms;
+    auto cliHost = clice::Argument{ .args             = "--host",
+                                    .value            = std::string{},
+                                    .completion       = [&]() {
+                                        std::this_thread::sleep_for(delay);
+                                        return std::vector<std::string>{fmt::format("v{}", generation)};
+                                    },
+                                    .completion_cache = clice::CompletionCache{ .ttl = 60s, .budget = 2000ms },
+    };
+    auto& arg  = cliHost.storage.arg;
+    auto  path = *clice::completionCacheFile(arg);
+    CHECK(path.parent_path() == dir / "clice");
+    // waits until the child refreshing the cache wrote values
+    auto waitForCache = [&](std::vector<std::string> const& values) {
+        for (int i{0}; i < 500 and clice::readCompletionCache(path) != values; ++i) {
+            std::this_thread::sleep_for(10ms);
+        }
+        return clice::readCompletionCache(path) == values;
+    };
+
+    // cold miss, the values are computed within the budget and written to the cache
+    CHECK(clice::completionValues(arg) == std::vector<std::string>{"v1"});
+    CHECK(clice::readCompletionCache(path) == std::vector<std::string>{"v1"});
+
+    // hit within the ttl, the generator isn't called
+    generation = 2;
+    CHECK(clice::completionValues(arg) == std::vector<std::string>{"v1"});
+
+    SECTION("stale values are served, then refreshed") {
+        arg.completion_cache->ttl    = 0s;
+        arg.completion_cache->budget = 10ms;
+        delay = 200ms;
+        CHECK(clice::completionValues(arg) == std::vector<std::string>{"v1"});
+        CHECK(waitpid(-1, nullptr, WNOHANG) == -1);
+        CHECK(waitForCache({"v2"}));
+        arg.completion_cache->ttl = 60s;
+        CHECK(clice::completionValues(arg) == std::vector<std::string>{"v2"});
+    }
+    SECTION("over budget without cache") {
+        std::filesystem::remove(path);
+        arg.completion_cache->budget = 10ms;
+        delay = 500ms;
+        CHECK(clice::completionValues(arg).empty());
+        CHECK(waitpid(-1, nullptr, WNOHANG) == -1); // the refresh is detached, no child left to reap
+        CHECK(waitForCache({"v2"}));
+    }
+
+    unsetenv("XDG_CACHE_HOME");
+    std::filesystem::remove_all(dir);
+}
+
+TEST_CASE("check completion mode", "completion") {
+    // output of clice::completeArguments
+    auto complete = [](std::vector<std::string_view> args) {
+        return captureStdout([&]() { clice::completeArguments(args); });
+    };
+
+    auto calls     = int{};
+    auto cliUint8  = clice::Argument{ .args = "--cmpl-uint8", .value = uint8_t{}, .cb = [&]() { ++calls; } };
+    auto cliMode   = clice::Argument{ .args    = "--cmpl-mode",
+                                      .value   = int{},
+                                      .cb      = [&]() { ++calls; },
+                                      .mapping = {{{"fast", 1}, {"slow", 2}}},
+    };
+    auto cliCmd    = clice::Argument{ .args = "cmpl-cmd", .cb = [&]() { ++calls; } };
+    auto cliCmdOpt = clice::Argument{ .parent = &cliCmd, .args = "--cmpl-opt", .value = int{}, .cb = [&]() { ++calls; } };
+
+    SECTION("malformed earlier values are tolerated") {
+        CHECK(complete({"app", "--cmpl-uint8", "abc", "--cmpl-m"}) == "--cmpl-mode\n");
+        CHECK(complete({"app", "--cmpl-uint8", "1000", "--cmpl-mode", ""}) == "fast\nslow\n");
+        CHECK(complete({"app", "cmpl-cmd", "--cmpl-opt", "x", "--cmpl-o"}) == "--cmpl-opt\n");
+    }
+    SECTION("no init, fromString or callbacks") {
+        complete({"app", "--cmpl-uint8", "7", "--cmpl-mode", "slow", "cmpl-cmd", "--cmpl-opt", "3", ""});
+        CHECK(calls == 0);
+        CHECK(!cliUint8);
+        CHECK(!cliMode);
+        CHECK(!cliCmd);
+        CHECK(!cliCmdOpt);
+        CHECK(*cliUint8 == 0);
+        CHECK(*cliMode == 0);
+        CHECK(*cliCmdOpt == 0);
+        CHECK(!cliUint8.storage.arg.isSet);
+    }
+}
+
+TEST_CASE("check static completion scripts", "completion") {
+    enum class Level { Low, High };
+    auto cliLevel = clice::Argument{ .args = "--level", .value = Level::Low, .mapping = {{{"low", Level::Low}, {"high", Level::High}}} };
+    auto cliHost  = clice::Argument{ .args = "--host", .value = std::string{}, .completion = []() { return std::vector<std::string>{}; } };
+    auto cliSync  = clice::Argument{ .args = "sync" };
+    auto cliDest  = clice::Argument{ .parent = &cliSync, .args = {"-d", "--dest"}, .value = std::filesystem::path{} };
+    auto oldArgv0 = std::exchange(clice::argv0, "/usr/bin/my-tool");
+
+    // the tables in front of the (static) completion function
+    auto tables = [](std::string_view shell) {
+        auto out = captureStdout([&]() { clice::printStaticCompletion(shell); });
+        auto registration = std::string{shell == "bash"?"complete -F _clice_my_tool my-tool\n"
+                                        :shell == "zsh"?"compdef _clice_my_tool my-tool\n"
+                                        :"complete -c my-tool -f -a '(_clice_my_tool)'\n"};
+        CHECK(out.ends_with(registration));
+        return out.substr(0, out.find(shell == "zsh"?"_clice_my_tool () {":"function "));
+    };
+    CHECK(tables("bash") == R"(declare -gA _clice_my_tool_child=(
+    ['0 --toast']='1'
+    ['0 --level']='2'
+    ['0 --host']='3'
+    ['0 sync']='4'
+    ['4 -d']='5'
+    ['4 --dest']='5'
+)
+declare -gA _clice_my_tool_kind=(
+    ['0']='0'
+    ['1']='1'
+    ['2']='1'
+    ['3']='1'
+    ['4']='0'
+    ['5']='1'
+)
+declare -gA _clice_my_tool_opts=(
+    ['0']='--host
+--level
+--toast
+sync'
+    ['1']=''
+    ['2']=''
+    ['3']=''
+    ['4']='-d'
+    ['5']=''
+)
+declare -gA _clice_my_tool_hint=(
+    ['2']='high
+low'
+    ['3']='@dynamic'
+    ['5']='@files'
+)
+)");
+    CHECK(tables("zsh") == R"(typeset -gA _clice_my_tool_child _clice_my_tool_kind _clice_my_tool_opts _clice_my_tool_hint
+_clice_my_tool_child=(
+    '0 --toast' '1'
+    '0 --level' '2'
+    '0 --host' '3'
+    '0 sync' '4'
+    '4 -d' '5'
+    '4 --dest' '5'
+)
+_clice_my_tool_kind=(
+    '0' '0'
+    '1' '1'
+    '2' '1'
+    '3' '1'
+    '4' '0'
+    '5' '1'
+)
+_clice_my_tool_opts=(
+    '0' '--host
+--level
+--toast
+sync'
+    '1' ''
+    '2' ''
+    '3' ''
+    '4' '-d'
+    '5' ''
+)
+_clice_my_tool_hint=(
+    '2' 'high
+low'
+    '3' '@dynamic'
+    '5' '@files'
+)
+)");
+    CHECK(tables("fish") == R"(set -g _clice_my_tool_child_keys '0 --toast' '0 --level' '0 --host' '0 sync' '4 -d' '4 --dest'
+set -g _clice_my_tool_child_vals 1 2 3 4 5 5
+set -g _clice_my_tool_kind 0 1 1 1 0 1
+set -g _clice_my_tool_opts '--host
+--level
+--toast
+sync' '' '' '' '-d' ''
+set -g _clice_my_tool_hint '' '' 'high
+low' '@dynamic' '' '@files'
+)");
+    clice::argv0 = oldArgv0;
+}